@@ -4,9 +4,18 @@
 #include <FastLED.h>
 
 // Base class for all ambient animations
-// Animations update all 4 channels simultaneously with non-blocking, timer-based updates
+// Animations update all channels simultaneously with non-blocking, timer-based updates
+//
+// CHANNELS (strip count) and LEDS (LEDs per strip) are fixed at compile time, so
+// per-LED state arrays and update loops are sized exactly to the hardware.
+template <uint8_t CHANNELS, uint16_t LEDS>
 class AnimationBase {
 public:
+    static constexpr uint16_t MAX_LEDS = LEDS;       // LEDs per channel
+    static constexpr uint16_t SLICE_LEDS = 50;       // LEDs per frame slice (see computeSlice)
+    static constexpr uint16_t SLICES_PER_CHANNEL = (LEDS + SLICE_LEDS - 1) / SLICE_LEDS;
+    static constexpr uint16_t FRAME_SLICES = CHANNELS * SLICES_PER_CHANNEL;
+
     virtual ~AnimationBase() {}
 
     // Initialize the animation
@@ -18,40 +27,92 @@ public:
     // deltaMs: milliseconds since last update
     virtual bool update(unsigned long deltaMs) = 0;
 
-    // Render the animation to the LED arrays
+    // Render the animation to the LED arrays (one MAX_LEDS array per channel)
     // Called after update() to apply the current frame
-    virtual void render(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) = 0;
+    virtual void render(CRGB* const channels[CHANNELS]) = 0;
 
     // Reset animation to initial state
     virtual void reset() = 0;
 
+    // Frame interval this animation needs (ms); frames run at this rate
+    // Animations derive it from their content (intervalForSpeed, intervalForStep)
+    virtual unsigned long frameIntervalMs() const { return FRAME_MS; }
+
+    // Resumable frames
+    // A frame can also be computed in slices, so a long strip never holds the
+    // loop for a whole frame: beginFrame() advances time and says whether a
+    // frame is due, then computeSlice() runs for slices 0..frameSlices()-1 in
+    // order, each updating and rendering its part of the frame.
+    // Defaults: the whole frame in one slice (update(), then render())
+    virtual bool beginFrame(unsigned long deltaMs) { return update(deltaMs); }
+    virtual uint16_t frameSlices() const { return 1; }
+    virtual void computeSlice(uint16_t slice, CRGB* const channels[CHANNELS]) {
+        (void)slice;
+        render(channels);
+    }
+
+    // Quality levels (see QualityGovernor)
+    // Level 0 is full detail; each level above it trades detail for less work
+    // per frame. Animations with knobs to turn override qualityLevels() and
+    // setQuality(); the manager only changes the level between frames.
+    virtual uint8_t qualityLevels() const { return 1; }
+    virtual void setQuality(uint8_t level) {
+        quality = (level < qualityLevels()) ? level : qualityLevels() - 1;
+    }
+    uint8_t getQuality() const { return quality; }
+
     // Get animation name (for debugging)
     virtual const char* getName() const = 0;
 
     // Set channel hues (called by manager when animation starts or hue changes)
     // Default implementation - derived classes can override
-    virtual void setChannelHues(int h1, int h2, int h3, int h4) {
-        channelHue[0] = h1;
-        channelHue[1] = h2;
-        channelHue[2] = h3;
-        channelHue[3] = h4;
+    virtual void setChannelHues(const int hues[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            channelHue[ch] = hues[ch];
+        }
     }
 
     // Set channel brightnesses (called by manager when brightness changes)
     // Default implementation - derived classes can override
-    virtual void setChannelBrightnesses(int b1, int b2, int b3, int b4) {
-        cachedBrightness[0] = b1;
-        cachedBrightness[1] = b2;
-        cachedBrightness[2] = b3;
-        cachedBrightness[3] = b4;
+    virtual void setChannelBrightnesses(const int brightnesses[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            cachedBrightness[ch] = brightnesses[ch];
+        }
     }
 
 protected:
+    AnimationBase() {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            channelHue[ch] = ch * 360 / CHANNELS;  // Default: evenly spaced around the wheel
+            cachedBrightness[ch] = 100;            // Default: full brightness
+        }
+    }
+
     // Common constants shared across animation types
-    static constexpr uint16_t MAX_LEDS = 200;
-    static constexpr unsigned long FRAME_MS = 50;    // 20fps
+    static constexpr unsigned long FRAME_MS = 50;    // 20fps (default frame interval)
+    static constexpr unsigned long MIN_FRAME_MS = 10;   // Fastest frame rate an animation may ask for (100 fps)
+    static constexpr unsigned long MAX_FRAME_MS = 200;  // Slowest (5 fps)
+
+    // Frame interval for motion at pixelsPerSecond, one pixel per frame
+    static constexpr unsigned long intervalForSpeed(uint16_t pixelsPerSecond) {
+        return clampInterval(1000UL / pixelsPerSecond);
+    }
+
+    // Frame interval at which a value changing unitsPerSecond moves at most maxStep per frame
+    static constexpr unsigned long intervalForStep(uint16_t maxStep, uint16_t unitsPerSecond) {
+        return clampInterval(1000UL * maxStep / unitsPerSecond);
+    }
+
+    static constexpr unsigned long clampInterval(unsigned long ms) {
+        return (ms < MIN_FRAME_MS) ? MIN_FRAME_MS : (ms > MAX_FRAME_MS) ? MAX_FRAME_MS : ms;
+    }
     static constexpr int ANGLE_WIDTH = 10;           // ±5° hue spread
 
+    // Analogous spread: sum of SPREAD_SAMPLES uniforms (near normal), or of
+    // REDUCED_SPREAD_SAMPLES (triangular) when quality asks for cheaper picks
+    static constexpr uint8_t SPREAD_SAMPLES = 6;
+    static constexpr uint8_t REDUCED_SPREAD_SAMPLES = 2;
+
     // Brightness knock-to-zero effect configuration
     static constexpr uint8_t BRIGHTNESS_KNOCK_ZERO_PCT = 5;  // % chance to knock to 0 at MAX
 
@@ -59,19 +120,48 @@ protected:
     static constexpr uint8_t PRIMARY_HUE_SAT = 0;  // White when primary hue chosen
 
     // Shared channel state (used by most animations)
-    int channelHue[4] = {0, 120, 240, 0};      // Default: R, G, B, White
-    int cachedBrightness[4] = {100, 100, 100, 100}; // Default: full brightness
+    int channelHue[CHANNELS];
+    int cachedBrightness[CHANNELS];
 
     // Frame timing accumulator
     unsigned long frameAccumulator = 0;
 
+    // Current quality level (0 = full detail)
+    uint8_t quality = 0;
+    bool reducedSpread = false;     // generateSpread() uses REDUCED_SPREAD_SAMPLES
+
+    // Advance frame timing; true if a frame is due (at frameIntervalMs())
+    bool advanceFrame(unsigned long deltaMs) {
+        unsigned long interval = frameIntervalMs();
+        frameAccumulator += deltaMs;
+        if (frameAccumulator < interval) return false;
+        frameAccumulator -= interval;
+        return true;
+    }
+
+    // Part of the frame a slice covers: SLICE_LEDS LEDs [from, to) of one channel
+    struct SliceRange {
+        uint8_t channel;
+        uint16_t from;
+        uint16_t to;
+    };
+
+    static SliceRange sliceRange(uint16_t slice) {
+        SliceRange range;
+        range.channel = slice / SLICES_PER_CHANNEL;
+        range.from = (slice % SLICES_PER_CHANNEL) * SLICE_LEDS;
+        range.to = (range.from + SLICE_LEDS < LEDS) ? range.from + SLICE_LEDS : LEDS;
+        return range;
+    }
+
     // Generate analogous spread offset using normal distribution approximation
     int generateSpread() {
+        int samples = reducedSpread ? REDUCED_SPREAD_SAMPLES : SPREAD_SAMPLES;
         int sum = 0;
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < samples; i++) {
             sum += random(0, ANGLE_WIDTH + 1);
         }
-        return (sum / 6) - (ANGLE_WIDTH / 2); // Centered at 0
+        return (sum / samples) - (ANGLE_WIDTH / 2); // Centered at 0
     }
 
     // Markov chain transition: returns -1, 0, or +1
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <Preferences.h>
+#include <new>
 #include "animation_base.h"
+#include "frame_slicer.h"
+#include "quality_governor.h"
 #include "runner/monochromatic_runner.h"
 #include "runner/complementary_runner.h"
 #include "runner/split_complementary_runner.h"
@@ -18,6 +21,7 @@
 #include "rain/triadic_rain.h"
 #include "rain/square_rain.h"
 #include "../led_channel.h"
+#include "../led_canvas.h"
 
 // Animation modes
 enum AnimationMode {
@@ -40,57 +44,91 @@ enum AnimationMode {
     ANIM_COUNT                  // Total number of modes (for cycling)
 };
 
+// Largest size/alignment of a set of types (for in-place construction)
+template <typename T, typename... Rest>
+struct LargestOf {
+    static constexpr size_t SIZE = (sizeof(T) > LargestOf<Rest...>::SIZE) ? sizeof(T) : LargestOf<Rest...>::SIZE;
+    static constexpr size_t ALIGN = (alignof(T) > LargestOf<Rest...>::ALIGN) ? alignof(T) : LargestOf<Rest...>::ALIGN;
+};
+
+template <typename T>
+struct LargestOf<T> {
+    static constexpr size_t SIZE = sizeof(T);
+    static constexpr size_t ALIGN = alignof(T);
+};
+
 // Animation Manager
-// Coordinates ambient animations across all 4 channels
+// Coordinates ambient animations across CHANNELS strips of LEDS LEDs each
 // Follows same pattern as NotificationManager
+//
+// Only the active animation exists: it is constructed in place in storage
+// sized for the largest animation, so RAM holds one animation's state rather
+// than all fifteen.
+//
+// Animations render SEGMENTS segments of SEGMENT_LEDS pixels into a canvas;
+// present() maps the canvas onto the strips (see LedCanvas). By default the
+// segments are the channels.
+//
+// Frames are computed in slices under a time budget (see FrameSlicer), so
+// update() returns within about ANIMATION_SLICE_BUDGET_US even mid-frame. The
+// canvas is only marked for present() once the last slice is done, and the
+// next frame does not start until that one has been presented, so the strips
+// never show half of a frame.
+//
+// Each animation runs at its own frame rate (AnimationBase::frameIntervalMs()),
+// so slow scenes compute fewer frames.
+//
+// A QualityGovernor watches how long frames take (including time the other
+// loop tasks take in between slices) and lowers the animation's quality level
+// while they run over ANIMATION_FRAME_BUDGET_US, restoring it once load drops.
+template <uint8_t CHANNELS, uint16_t LEDS, uint8_t SEGMENTS = CHANNELS, uint16_t SEGMENT_LEDS = LEDS>
 class AnimationManager {
 public:
-    AnimationManager(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) :
-        channel1(ch1), channel2(ch2), channel3(ch3), channel4(ch4),
-        numLedsPerChannel(numLeds),
-        channelService1(nullptr), channelService2(nullptr),
-        channelService3(nullptr), channelService4(nullptr),
+    typedef AnimationBase<SEGMENTS, SEGMENT_LEDS> Animation;
+    typedef LedCanvas<SEGMENTS, SEGMENT_LEDS, CHANNELS, LEDS> Canvas;
+
+    // channels: CHANNELS LED arrays of LEDS each
+    AnimationManager(CRGB* const channels[CHANNELS]) :
         currentMode(ANIM_NONE),
         lastUpdateMs(0),
-        currentAnimation(nullptr) {
-        // Initialize lookup table
-        animations[ANIM_NONE] = nullptr;
-        animations[ANIM_MONOCHROMATIC_RUNNER] = &monochromaticRunnerAnim;
-        animations[ANIM_COMPLEMENTARY_RUNNER] = &complementaryRunnerAnim;
-        animations[ANIM_SPLIT_COMPLEMENTARY_RUNNER] = &splitComplementaryRunnerAnim;
-        animations[ANIM_TRIADIC_RUNNER] = &triadicRunnerAnim;
-        animations[ANIM_SQUARE_RUNNER] = &squareRunnerAnim;
-        animations[ANIM_MONOCHROMATIC_RAIN] = &monochromaticRainAnim;
-        animations[ANIM_COMPLEMENTARY_RAIN] = &complementaryRainAnim;
-        animations[ANIM_SPLIT_COMPLEMENTARY_RAIN] = &splitComplementaryRainAnim;
-        animations[ANIM_TRIADIC_RAIN] = &triadicRainAnim;
-        animations[ANIM_SQUARE_RAIN] = &squareRainAnim;
-        animations[ANIM_MONOCHROMATIC] = &monochromaticAnim;
-        animations[ANIM_COMPLEMENTARY] = &complementaryAnim;
-        animations[ANIM_SPLIT_COMPLEMENTARY] = &splitComplementaryAnim;
-        animations[ANIM_TRIADIC] = &triadicAnim;
-        animations[ANIM_SQUARE] = &squareAnim;
+        currentAnimation(nullptr),
+        slicer(micros, ANIMATION_SLICE_BUDGET_US),
+        governor(ANIMATION_FRAME_BUDGET_US),
+        canvasDirty(false) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            this->channels[ch] = channels[ch];
+            channelServices[ch] = nullptr;
+        }
 
         // Load saved animation mode from NVS
         loadMode();
     }
 
+    ~AnimationManager() {
+        destroyAnimation();
+    }
+
     // Set channel service pointers (call after channel services are created)
-    void setChannelServices(DEV_LedChannel* ch1, DEV_LedChannel* ch2, DEV_LedChannel* ch3, DEV_LedChannel* ch4) {
-        channelService1 = ch1;
-        channelService2 = ch2;
-        channelService3 = ch3;
-        channelService4 = ch4;
+    void setChannelServices(DEV_LedChannel* const services[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            channelServices[ch] = services[ch];
+        }
 
         // Restore saved animation mode (if any)
         if (currentMode != ANIM_NONE) {
-            Serial.printf("Restoring saved animation: %s\n", getModeName(currentMode));
+            Serial.printf("Restoring saved animation mode %d\n", currentMode);
             AnimationMode savedMode = currentMode;
             currentMode = ANIM_NONE;  // Reset to trigger proper initialization
             setMode(savedMode);
         }
     }
 
+    // Map canvas segments onto the strips (false if the layout is invalid)
+    template <size_t N>
+    bool setLayout(const SegmentRun (&runs)[N]) {
+        return canvas.setLayout(runs);
+    }
+
     // Cycle to next animation mode
     void cycleMode() {
         AnimationMode nextMode = (AnimationMode)((currentMode + 1) % ANIM_COUNT);
@@ -106,34 +144,82 @@ public:
 
         currentMode = mode;
 
-        // Save to NVS
-        saveMode();
-
         // Start new animation
         if (currentMode != ANIM_NONE) {
             startCurrentAnimation();
         }
 
-        Serial.printf("Animation mode: %s\n", getModeName(currentMode));
+        // Save to NVS
+        saveMode();
+
+        Serial.printf("Animation mode: %s\n", getModeName());
     }
 
     // Update animation state (call from loop)
-    void update() {
+    // Returns true while a frame is partly computed (call again soon to finish it)
+    bool update() {
         if (!currentAnimation) {
-            return;  // No animation active
+            return false;  // No animation active
         }
 
-        unsigned long now = millis();
-        unsigned long deltaMs = now - lastUpdateMs;
-        lastUpdateMs = now;
+        if (!slicer.inProgress()) {
+            // Hold the finished frame until present() has picked it up
+            if (canvasDirty) return false;
+
+            unsigned long now = millis();
+            unsigned long deltaMs = now - lastUpdateMs;
+            lastUpdateMs = now;
 
-        // Update current animation (polymorphic dispatch)
-        bool needsRender = currentAnimation->update(deltaMs);
+            // Start the next frame if one is due (polymorphic dispatch)
+            if (!currentAnimation->beginFrame(deltaMs)) return false;
 
-        // Render if needed
-        if (needsRender) {
-            renderCurrentAnimation();
+            // Hues and brightnesses only change between frames
+            applyChannelState();
+            slicer.start(currentAnimation->frameSlices());
         }
+
+        // Compute slices into the canvas; commit once the frame is complete
+        if (!slicer.run(currentAnimation, canvas.segments())) return true;
+        canvasDirty = true;
+
+        // Pick the quality of the next frame from how long this one took
+        currentAnimation->setQuality(governor.update(slicer.getLastFrameUs()));
+        return false;
+    }
+
+    // Frame computation budget per update() call
+    void setSliceBudget(uint32_t budgetUs) {
+        slicer.setBudget(budgetUs);
+    }
+
+    // Slicing telemetry: longest update() run and runs since the last reset
+    uint32_t getMaxSliceRunUs() const { return slicer.getMaxRunUs(); }
+    uint32_t getSliceRuns() const { return slicer.getRuns(); }
+    void resetSliceStats() { slicer.resetStats(); }
+
+    // Frame interval of the active animation (ms; each animation sets its own rate)
+    unsigned long getFrameIntervalMs() const { return currentAnimation ? currentAnimation->frameIntervalMs() : 0; }
+
+    // Quality telemetry: current level (0 = full detail) of how many, average frame time
+    uint8_t getQualityLevel() const { return governor.level(); }
+    uint8_t getQualityLevels() const { return currentAnimation ? currentAnimation->qualityLevels() : 1; }
+    uint32_t getAverageFrameUs() const { return governor.averageFrameUs(); }
+
+    // Copy the last rendered frame onto the strips (call before showing the strips)
+    // Returns false if nothing was rendered since the last call
+    bool present() {
+        if (!canvasDirty) return false;
+        canvasDirty = false;
+
+        canvas.gather(channels);
+
+        // Respect HomeKit power state: turn off channels that are OFF
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            if (channelServices[ch] && !channelServices[ch]->desired.power) {
+                fill_solid(channels[ch], LEDS, CRGB::Black);
+            }
+        }
+        return true;
     }
 
     // Get current mode
@@ -157,81 +243,106 @@ public:
     }
 
 private:
-    CRGB* channel1;
-    CRGB* channel2;
-    CRGB* channel3;
-    CRGB* channel4;
-    uint16_t numLedsPerChannel;
-
-    DEV_LedChannel* channelService1;
-    DEV_LedChannel* channelService2;
-    DEV_LedChannel* channelService3;
-    DEV_LedChannel* channelService4;
+    CRGB* channels[CHANNELS];
+    DEV_LedChannel* channelServices[CHANNELS];
 
     AnimationMode currentMode;
     unsigned long lastUpdateMs;
 
     // Polymorphic dispatch
-    AnimationBase* animations[ANIM_COUNT];
-    AnimationBase* currentAnimation;
-
-    // Animation instances
-    MonochromaticRunner monochromaticRunnerAnim;
-    ComplementaryRunner complementaryRunnerAnim;
-    SplitComplementaryRunner splitComplementaryRunnerAnim;
-    TriadicRunner triadicRunnerAnim;
-    SquareRunner squareRunnerAnim;
-    MonochromaticRain monochromaticRainAnim;
-    ComplementaryRain complementaryRainAnim;
-    SplitComplementaryRain splitComplementaryRainAnim;
-    TriadicRain triadicRainAnim;
-    SquareRain squareRainAnim;
-    MonochromaticTwinkle monochromaticAnim;
-    ComplementaryTwinkle complementaryAnim;
-    SplitComplementaryTwinkle splitComplementaryAnim;
-    TriadicTwinkle triadicAnim;
-    SquareTwinkle squareAnim;
+    Animation* currentAnimation;
+    FrameSlicer<SEGMENTS, SEGMENT_LEDS> slicer;
+    QualityGovernor governor;
+
+    // Logical canvas the animation renders into
+    Canvas canvas;
+    bool canvasDirty;       // Rendered since the last present()
+
+    // Storage for the active animation instance
+    typedef LargestOf<
+        MonochromaticRunner<SEGMENTS, SEGMENT_LEDS>, ComplementaryRunner<SEGMENTS, SEGMENT_LEDS>,
+        SplitComplementaryRunner<SEGMENTS, SEGMENT_LEDS>, TriadicRunner<SEGMENTS, SEGMENT_LEDS>, SquareRunner<SEGMENTS, SEGMENT_LEDS>,
+        MonochromaticRain<SEGMENTS, SEGMENT_LEDS>, ComplementaryRain<SEGMENTS, SEGMENT_LEDS>,
+        SplitComplementaryRain<SEGMENTS, SEGMENT_LEDS>, TriadicRain<SEGMENTS, SEGMENT_LEDS>, SquareRain<SEGMENTS, SEGMENT_LEDS>,
+        MonochromaticTwinkle<SEGMENTS, SEGMENT_LEDS>, ComplementaryTwinkle<SEGMENTS, SEGMENT_LEDS>,
+        SplitComplementaryTwinkle<SEGMENTS, SEGMENT_LEDS>, TriadicTwinkle<SEGMENTS, SEGMENT_LEDS>, SquareTwinkle<SEGMENTS, SEGMENT_LEDS>
+    > AnimationStorage;
+    alignas(AnimationStorage::ALIGN) uint8_t animationStorage[AnimationStorage::SIZE];
 
     // Storage for saved LED state (when entering animation mode)
-    CRGB savedCh1[200];
-    CRGB savedCh2[200];
-    CRGB savedCh3[200];
-    CRGB savedCh4[200];
+    CRGB saved[CHANNELS][LEDS];
+
+    // Construct the animation for a mode in the shared storage
+    Animation* createAnimation(AnimationMode mode) {
+        void* mem = animationStorage;
+        switch (mode) {
+            case ANIM_MONOCHROMATIC_RUNNER:       return new (mem) MonochromaticRunner<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_COMPLEMENTARY_RUNNER:       return new (mem) ComplementaryRunner<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SPLIT_COMPLEMENTARY_RUNNER: return new (mem) SplitComplementaryRunner<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_TRIADIC_RUNNER:             return new (mem) TriadicRunner<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SQUARE_RUNNER:              return new (mem) SquareRunner<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_MONOCHROMATIC_RAIN:         return new (mem) MonochromaticRain<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_COMPLEMENTARY_RAIN:         return new (mem) ComplementaryRain<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SPLIT_COMPLEMENTARY_RAIN:   return new (mem) SplitComplementaryRain<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_TRIADIC_RAIN:               return new (mem) TriadicRain<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SQUARE_RAIN:                return new (mem) SquareRain<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_MONOCHROMATIC:              return new (mem) MonochromaticTwinkle<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_COMPLEMENTARY:              return new (mem) ComplementaryTwinkle<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SPLIT_COMPLEMENTARY:        return new (mem) SplitComplementaryTwinkle<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_TRIADIC:                    return new (mem) TriadicTwinkle<SEGMENTS, SEGMENT_LEDS>();
+            case ANIM_SQUARE:                     return new (mem) SquareTwinkle<SEGMENTS, SEGMENT_LEDS>();
+            default:                              return nullptr;
+        }
+    }
+
+    void destroyAnimation() {
+        slicer.cancel();
+        if (currentAnimation) {
+            currentAnimation->~Animation();
+            currentAnimation = nullptr;
+        }
+    }
+
+    bool haveAllServices() const {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            if (!channelServices[ch]) return false;
+        }
+        return true;
+    }
+
+    // Push hues and brightnesses from HomeKit state to the animation (polymorphic dispatch)
+    void applyChannelState() {
+        if (!haveAllServices()) return;
+
+        int hues[SEGMENTS];
+        int brightnesses[SEGMENTS];
+        for (uint8_t seg = 0; seg < SEGMENTS; seg++) {
+            const DEV_LedChannel* service = channelServices[canvas.ownerChannel(seg)];
+            hues[seg] = service->desired.hue;
+            brightnesses[seg] = service->desired.brightness;
+        }
+        currentAnimation->setChannelHues(hues);
+        currentAnimation->setChannelBrightnesses(brightnesses);
+    }
 
     void startCurrentAnimation() {
-        // Tell all channel services to yield to animation
-        if (channelService1) channelService1->yieldToAnimation();
-        if (channelService2) channelService2->yieldToAnimation();
-        if (channelService3) channelService3->yieldToAnimation();
-        if (channelService4) channelService4->yieldToAnimation();
-
-        // Save current LED state
-        for (int i = 0; i < numLedsPerChannel; i++) {
-            savedCh1[i] = channel1[i];
-            savedCh2[i] = channel2[i];
-            savedCh3[i] = channel3[i];
-            savedCh4[i] = channel4[i];
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            // Tell the channel service to yield to animation
+            if (channelServices[ch]) channelServices[ch]->yieldToAnimation();
+
+            // Save current LED state
+            for (uint16_t i = 0; i < LEDS; i++) {
+                saved[ch][i] = channels[ch][i];
+            }
         }
 
-        // Set current animation pointer
-        currentAnimation = animations[currentMode];
+        // Construct the animation for this mode (at full quality)
+        currentAnimation = createAnimation(currentMode);
         if (!currentAnimation) return;
+        governor.reset(currentAnimation->qualityLevels());
 
-        // Set channel hues and brightnesses from HomeKit state (polymorphic dispatch)
-        if (channelService1 && channelService2 && channelService3 && channelService4) {
-            currentAnimation->setChannelHues(
-                channelService1->desired.hue,
-                channelService2->desired.hue,
-                channelService3->desired.hue,
-                channelService4->desired.hue
-            );
-            currentAnimation->setChannelBrightnesses(
-                channelService1->desired.brightness,
-                channelService2->desired.brightness,
-                channelService3->desired.brightness,
-                channelService4->desired.brightness
-            );
-        }
+        // Set channel hues and brightnesses from HomeKit state
+        applyChannelState();
 
         // Initialize animation (polymorphic dispatch)
         currentAnimation->begin();
@@ -239,64 +350,25 @@ private:
     }
 
     void stopCurrentAnimation() {
-        // Clear current animation pointer
-        currentAnimation = nullptr;
-
-        // Restore saved LED state
-        for (int i = 0; i < numLedsPerChannel; i++) {
-            channel1[i] = savedCh1[i];
-            channel2[i] = savedCh2[i];
-            channel3[i] = savedCh3[i];
-            channel4[i] = savedCh4[i];
-        }
-
-        // Tell all channel services to resume from animation
-        if (channelService1) channelService1->resumeFromAnimation();
-        if (channelService2) channelService2->resumeFromAnimation();
-        if (channelService3) channelService3->resumeFromAnimation();
-        if (channelService4) channelService4->resumeFromAnimation();
-    }
-
-    void renderCurrentAnimation() {
-        if (!currentAnimation) return;
-
-        // Update animation hues and brightnesses from current HomeKit state (polymorphic dispatch)
-        if (channelService1 && channelService2 && channelService3 && channelService4) {
-            currentAnimation->setChannelHues(
-                channelService1->desired.hue,
-                channelService2->desired.hue,
-                channelService3->desired.hue,
-                channelService4->desired.hue
-            );
-            currentAnimation->setChannelBrightnesses(
-                channelService1->desired.brightness,
-                channelService2->desired.brightness,
-                channelService3->desired.brightness,
-                channelService4->desired.brightness
-            );
-        }
-
-        // Render animation (polymorphic dispatch)
-        currentAnimation->render(channel1, channel2, channel3, channel4, numLedsPerChannel);
+        // Release the animation instance
+        destroyAnimation();
+        canvasDirty = false;
+
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            // Restore saved LED state
+            for (uint16_t i = 0; i < LEDS; i++) {
+                channels[ch][i] = saved[ch][i];
+            }
 
-        // Respect HomeKit power state: turn off channels that are OFF
-        if (channelService1 && !channelService1->desired.power) {
-            fill_solid(channel1, numLedsPerChannel, CRGB::Black);
-        }
-        if (channelService2 && !channelService2->desired.power) {
-            fill_solid(channel2, numLedsPerChannel, CRGB::Black);
-        }
-        if (channelService3 && !channelService3->desired.power) {
-            fill_solid(channel3, numLedsPerChannel, CRGB::Black);
-        }
-        if (channelService4 && !channelService4->desired.power) {
-            fill_solid(channel4, numLedsPerChannel, CRGB::Black);
+            // Tell the channel service to resume from animation
+            if (channelServices[ch]) channelServices[ch]->resumeFromAnimation();
         }
     }
 
-    const char* getModeName(AnimationMode mode) const {
-        if (mode == ANIM_NONE) return "HomeKit";
-        if (mode < ANIM_COUNT && animations[mode]) return animations[mode]->getName();
+    // Name of the current mode (animations only exist while active)
+    const char* getModeName() const {
+        if (currentMode == ANIM_NONE) return "HomeKit";
+        if (currentAnimation) return currentAnimation->getName();
         return "Unknown";
     }
 
@@ -311,13 +383,10 @@ private:
             uint8_t savedMode = prefs.getUChar("mode", 0);
             if (savedMode < ANIM_COUNT) {
                 currentMode = (AnimationMode)savedMode;
-                Serial.printf("Loaded animation mode from NVS: %s\n", getModeName(currentMode));
+                Serial.printf("Loaded animation mode from NVS: %d\n", savedMode);
 
-                // Start the saved animation
-                if (currentMode != ANIM_NONE) {
-                    // Note: This will be called in setup() after channel services are configured
-                    // The actual animation start happens when setChannelServices() is called
-                }
+                // The saved animation starts when setChannelServices() is called
+                // (in setup(), after channel services are configured)
             }
         }
 
@@ -335,6 +404,6 @@ private:
         prefs.putUChar("mode", (uint8_t)currentMode);
         prefs.end();
 
-        Serial.printf("Saved animation mode to NVS: %s\n", getModeName(currentMode));
+        Serial.printf("Saved animation mode to NVS: %s\n", getModeName());
     }
 };
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "animation_base.h"
+#include "harmony_palette.h"
+
+// Shared part of the base layer engines (MarkovBaseLayer, NoiseBaseLayer)
+//
+// The overlay families (Runner, Rain) take their base layer as a template
+// parameter and derive from it. Every engine derives from this class and
+// provides the same interface:
+//
+//   resetBaseLayer()                 initial state (called from reset())
+//   beginBaseFrame()                 once per frame, before stepping
+//   baseStepDue                      whether this frame steps the base layer
+//   updateBaseLayer()                step every channel
+//   updateBaseRange(ch, from, to)    step LEDs [from, to) of one channel (one slice)
+//   baseColorAt(ch, i)               base color of an LED
+//
+// This class holds what does not depend on the engine: the per-channel
+// palettes, the harmony color pick for overlays, and the quality levels the
+// overlays share.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class BaseLayerCore : public AnimationBase<CHANNELS, LEDS>
+{
+public:
+    typedef AnimationBase<CHANNELS, LEDS> Base;
+    using Base::MAX_LEDS;
+
+    // Tunable parameters for base layer
+    static constexpr uint8_t BASE_BRIGHTNESS = 40;   // Min breathing brightness
+    static constexpr uint8_t MAX_BRIGHTNESS = 220;   // Max breathing brightness
+
+    // Quality levels (shared by the overlay families)
+    //   0: full detail
+    //   1: base layer steps every other frame
+    //   2: + half as many overlays (raindrops, runners)
+    //   3: + cheaper spread for new overlay colors
+    // Engines may add levels above these
+    static constexpr uint8_t QUALITY_HALF_RATE_BASE = 1;
+    static constexpr uint8_t QUALITY_FEWER_OVERLAYS = 2;
+    static constexpr uint8_t QUALITY_REDUCED_SPREAD = 3;
+
+    uint8_t qualityLevels() const override { return 4; }
+
+    void setQuality(uint8_t level) override
+    {
+        Base::setQuality(level);
+        this->reducedSpread = this->quality >= QUALITY_REDUCED_SPREAD;
+    }
+
+protected:
+    using Base::ANGLE_WIDTH;
+    using Base::generateSpread;
+
+    // Upsampling weights between two samples 8 LEDs apart (smoothstep 3t^2 - 2t^3, 1/256) at t = k/8
+    static constexpr uint8_t SMOOTHSTEP_SHIFT = 3;
+    static constexpr uint8_t SMOOTHSTEP[1 << SMOOTHSTEP_SHIFT] = {0, 11, 40, 81, 128, 175, 216, 245};
+
+    // Per-channel color palettes
+    typedef HarmonyPalette<ANGLE_WIDTH> Palette;
+    Palette palette[CHANNELS];
+
+    // Whether the base layer steps this frame (see beginBaseFrame)
+    bool baseStepDue = true;
+    bool oddFrame = false;
+
+    // Call once per frame before stepping: at QUALITY_HALF_RATE_BASE and
+    // above the base layer holds still every other frame
+    void beginBaseFrame()
+    {
+        oddFrame = !oddFrame;
+        baseStepDue = this->quality < QUALITY_HALF_RATE_BASE || oddFrame;
+    }
+
+    // Pick a harmony color for overlay effects (runners, raindrops, etc.)
+    // Returns a palette index; the offsets table only fixes the hue count
+    template <int NUM_HUES>
+    uint8_t pickHarmonyColor(const int (&)[NUM_HUES])
+    {
+        int idx = (NUM_HUES > 1) ? random(NUM_HUES) : 0;
+        return Palette::harmonyIndex(idx, generateSpread());
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "animation_base.h"
+
+// Resumable, time-sliced frame computation
+// A frame is computed slice by slice (AnimationBase::computeSlice): each run()
+// keeps computing slices until the microsecond budget is spent, then returns so
+// the rest of loop() (HomeSpan, buttons) can run, and the next run() resumes
+// where it stopped. A call therefore lasts at most budget + one slice, however
+// long the strips are.
+//
+// The frame only counts as done when its last slice is computed; the caller
+// commits it then (the canvas is presented only after a complete frame).
+//
+// The slicer also times each frame from start() to its last slice, which is
+// what the quality governor watches.
+//
+// Time comes from an injected microsecond clock, like TaskScheduler.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class FrameSlicer {
+public:
+    typedef AnimationBase<CHANNELS, LEDS> Animation;
+    typedef unsigned long (*ClockFn)();
+
+    FrameSlicer(ClockFn clockUs, uint32_t budgetUs) :
+        clock(clockUs),
+        budgetUs(budgetUs),
+        slices(0),
+        nextSlice(0),
+        frameStartUs(0),
+        lastFrameUs(0),
+        maxRunUs(0),
+        runs(0) {}
+
+    void setBudget(uint32_t budgetUs) { this->budgetUs = budgetUs; }
+
+    // Start a frame of the given number of slices
+    void start(uint16_t slices) {
+        this->slices = slices;
+        nextSlice = 0;
+        frameStartUs = clock();
+    }
+
+    // Drop the frame in progress (animation changed or stopped)
+    void cancel() { slices = 0; nextSlice = 0; }
+
+    // Frame started and not complete yet
+    bool inProgress() const { return nextSlice < slices; }
+
+    // Compute slices until the budget is spent (at least one)
+    // Returns true when the frame is complete
+    bool run(Animation* animation, CRGB* const channels[CHANNELS]) {
+        if (!inProgress()) return true;
+
+        unsigned long begin = clock();
+        unsigned long elapsed;
+        do {
+            animation->computeSlice(nextSlice++, channels);
+            elapsed = clock() - begin;
+        } while (inProgress() && elapsed < budgetUs);
+
+        if (elapsed > maxRunUs) maxRunUs = elapsed;
+        runs++;
+        if (inProgress()) return false;
+
+        lastFrameUs = clock() - frameStartUs;
+        return true;
+    }
+
+    // Time from start() to the last slice of the last complete frame (us)
+    uint32_t getLastFrameUs() const { return lastFrameUs; }
+
+    // Longest single run() so far (us) and number of runs (for telemetry)
+    uint32_t getMaxRunUs() const { return maxRunUs; }
+    uint32_t getRuns() const { return runs; }
+
+    void resetStats() {
+        maxRunUs = 0;
+        runs = 0;
+    }
+
+private:
+    ClockFn clock;
+    uint32_t budgetUs;
+    uint16_t slices;            // Slices in the current frame
+    uint16_t nextSlice;         // Next slice to compute
+    unsigned long frameStartUs;
+    uint32_t lastFrameUs;
+    uint32_t maxRunUs;
+    uint32_t runs;
+};
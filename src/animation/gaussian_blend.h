@@ -1,33 +1,57 @@
 #pragma once
 
-#include <math.h>
-#include <Arduino.h>
+#include "../lookup_table.h"
+#include "../fixed_point.h"
 
-// Gaussian Blend Lookup Table
-// Provides precomputed Gaussian curve values for smooth blending
+// Gaussian Blend Lookup Tables
+// Precomputed Gaussian curve values for smooth blending, generated at compile time
 //
 // Usage:
-//   GaussianBlendLUT<30> lut;
-//   lut.compute(2.5f);  // variance parameter
-//   uint8_t blend = lut.table[i];  // 0-255 blend factor
+//   static constexpr Lut<uint8_t, 30> lut = makeGaussianBlendLut<30>(2.5);  // variance
+//   uint8_t blend = lut[i];  // 0-255 blend factor
 //
-// The table is centered, so table[LENGTH/2] is the peak (255)
+// The table is centered, so lut[LENGTH/2] is the peak (255)
 // and values decay toward 0 at the edges.
+//
+// variance: Controls the width of the curve (higher = wider blob)
+//   - 2.5 gives ~6-8 pixel visible width at center
+//   - 5.0 gives ~12-14 pixel visible width at center
 template <uint8_t LENGTH>
-struct GaussianBlendLUT {
-    uint8_t table[LENGTH];
+constexpr Lut<uint8_t, LENGTH> makeGaussianBlendLut(double variance) {
+    return makeLut<uint8_t, LENGTH>([variance](size_t i) {
+        double x = i - LENGTH / 2.0;
+        return lutmath::toU8(lutmath::exp(-(x * x) / (2.0 * variance)));
+    });
+}
+
+// Time-varying Gaussian: table[frame][distance] for a blob that widens and fades
+// Variance grows linearly from minVariance (frame 0) to maxVariance (frame FRAMES),
+// and amplitude fades linearly from 1 to 0 over the same span.
+// Distance is |led - center|, 0..HALF_WIDTH.
+template <uint8_t FRAMES, uint8_t HALF_WIDTH>
+constexpr Lut<Lut<uint8_t, HALF_WIDTH + 1>, FRAMES> makeFadingGaussianLut(double minVariance, double maxVariance) {
+    return makeLut<Lut<uint8_t, HALF_WIDTH + 1>, FRAMES>([minVariance, maxVariance](size_t frame) {
+        double progress = frame / (double)FRAMES;
+        double variance = minVariance + progress * (maxVariance - minVariance);
+        return makeLut<uint8_t, HALF_WIDTH + 1>([variance, progress](size_t x) {
+            double spatial = lutmath::exp(-(double)(x * x) / (2.0 * variance));
+            return lutmath::toU8(spatial * (1.0 - progress));
+        });
+    });
+}
 
-    // Compute Gaussian curve with given variance
-    // variance: Controls the width of the curve (higher = wider blob)
-    //   - 2.5 gives ~6-8 pixel visible width at center
-    //   - 5.0 gives ~12-14 pixel visible width at center
-    void compute(float variance) {
-        float halfLen = LENGTH / 2.0f;
-        for (uint8_t i = 0; i < LENGTH; i++) {
-            float x = (i - halfLen);
-            float g = expf(-(x * x) / (2.0f * variance));
-            int val = (int)(g * 255.0f + 0.5f);
-            table[i] = (uint8_t)constrain(val, 0, 255);
-        }
-    }
-};
+// Sub-pixel Gaussian: table[phase][k] for a blob whose position has a fraction
+// of phase / PHASES of a pixel. k = 0..LENGTH covers one more LED than the
+// whole-pixel table (the blob straddles it); phase 0 matches
+// makeGaussianBlendLut<LENGTH>, and each phase samples the curve shifted by
+// its fraction, so a blob moving in sub-pixel steps has no judder.
+template <uint8_t LENGTH, uint8_t PHASES>
+constexpr Lut<Lut<uint8_t, LENGTH + 1>, PHASES> makeSubpixelGaussianLut(double variance) {
+    return makeLut<Lut<uint8_t, LENGTH + 1>, PHASES>([variance](size_t phase) {
+        double shift = phase / (double)PHASES;
+        return makeLut<uint8_t, LENGTH + 1>([variance, shift](size_t k) {
+            double x = k - shift - LENGTH / 2.0;
+            return lutmath::toU8(lutmath::exp(-(x * x) / (2.0 * variance)));
+        });
+    });
+}
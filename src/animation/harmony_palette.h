@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "../lookup_table.h"
+
+// Per-channel palette of precomputed RGB colors for harmony animations
+//
+// A channel only ever shows a handful of hues: its base hue plus the harmony
+// hues, each with a small analogous spread. The palette holds every
+// (hue slot, spread step) combination at full value, so rendering an LED is a
+// table lookup plus a brightness scale instead of an HSV->RGB conversion.
+// The palette is rebuilt only when the channel hue changes.
+//
+// Layout: slot 0 is the base layer hue (full saturation), slots 1..MAX_HUES are
+// the harmony hues (primary desaturated). Each slot holds SPREAD_WIDTH + 1
+// entries covering -SPREAD_WIDTH/2 .. +SPREAD_WIDTH/2 degrees.
+template <int SPREAD_WIDTH>
+class HarmonyPalette {
+public:
+    static constexpr uint8_t MAX_HUES = 4;
+    static constexpr uint8_t SPREAD_STEPS = SPREAD_WIDTH + 1;
+    static constexpr uint8_t SIZE = (1 + MAX_HUES) * SPREAD_STEPS;
+
+    // Palette index for the base layer at a given spread (degrees)
+    static uint8_t baseIndex(int spread) {
+        return spread + SPREAD_WIDTH / 2;
+    }
+
+    // Palette index for harmony hue h (0 = primary) at a given spread (degrees)
+    static uint8_t harmonyIndex(uint8_t h, int spread) {
+        return (1 + h) * SPREAD_STEPS + spread + SPREAD_WIDTH / 2;
+    }
+
+    // Rebuild for a new channel hue (0-360)
+    // offsets: harmony hue offsets from primary; primarySat: saturation of the 0° hue
+    template <int NUM_HUES>
+    void build(int hue360, const int (&offsets)[NUM_HUES], uint8_t primarySat) {
+        static_assert(NUM_HUES <= MAX_HUES, "Too many harmony hues for palette");
+
+        buildSlot(0, hue360, 255);
+        for (uint8_t h = 0; h < NUM_HUES; h++) {
+            buildSlot(1 + h, hue360 + offsets[h], (offsets[h] == 0) ? primarySat : 255);
+        }
+    }
+
+    // Same spread step as index, moved to harmony hue h
+    static uint8_t withHarmony(uint8_t index, uint8_t h) {
+        return (1 + h) * SPREAD_STEPS + index % SPREAD_STEPS;
+    }
+
+    // Full-value color at a palette index
+    const CRGB& entry(uint8_t index) const { return colors[index]; }
+
+    // Color at a palette index scaled to an intensity (0-255)
+    CRGB color(uint8_t index, uint8_t intensity) const {
+        const CRGB& c = colors[index];
+        return CRGB(scale8_video(c.r, intensity), scale8_video(c.g, intensity), scale8_video(c.b, intensity));
+    }
+
+private:
+    CRGB colors[SIZE];
+
+    void buildSlot(uint8_t slot, int hue360, uint8_t sat) {
+        for (int s = 0; s < SPREAD_STEPS; s++) {
+            colors[slot * SPREAD_STEPS + s] = CHSV(hue8FromDegrees(hue360 + s - SPREAD_WIDTH / 2), sat, 255);
+        }
+    }
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "animation_base.h"
+#include "base_layer_core.h"
 
 // Intermediate base class for animations that use Markov chain base layer
 //
@@ -10,86 +10,235 @@
 //   - Markov chain has momentum (60% chance to continue current direction)
 //
 // Derived classes (Runner, Rain) add overlay effects on top of this base layer
-// and must implement getHarmonyOffsets() and getNumHarmonyHues()
-class MarkovBaseLayer : public AnimationBase
+// (the default; NoiseBaseLayer is the stateless alternative, same interface -
+// see BaseLayerCore). Harmonies are resolved at compile time: the family bases
+// take the leaf class as a template parameter (CRTP) and pass its
+// HARMONY_OFFSETS table to pickHarmonyColor(), so only the AnimationBase
+// interface is virtual.
+//
+// Colors come from a per-channel HarmonyPalette (base hue + harmony hues with
+// spread), rebuilt by the harmony layer when channel hues change.
+//
+// Level of detail: the breathing is low-frequency, so the walk can run on a
+// grid of every 2nd, 4th or 8th LED and be upsampled (smoothstep between grid
+// points) when rendering. BASE_DECIMATION is the finest grid an animation uses
+// and sizes the state; the quality governor can coarsen the grid further.
+template <uint8_t CHANNELS, uint16_t LEDS, uint8_t BASE_DECIMATION = 1>
+class MarkovBaseLayer : public BaseLayerCore<CHANNELS, LEDS>
 {
 public:
-    // Tunable parameters for base layer
-    static constexpr uint8_t BASE_BRIGHTNESS = 40;   // Min breathing brightness
-    static constexpr uint8_t MAX_BRIGHTNESS = 220;   // Max breathing brightness
+    typedef BaseLayerCore<CHANNELS, LEDS> LayerCore;
+    typedef typename LayerCore::Base Base;
+    using Base::MAX_LEDS;
+    using LayerCore::BASE_BRIGHTNESS;
+    using LayerCore::MAX_BRIGHTNESS;
+    using LayerCore::QUALITY_REDUCED_SPREAD;
+
+    static_assert(BASE_DECIMATION == 1 || BASE_DECIMATION == 2 || BASE_DECIMATION == 4 || BASE_DECIMATION == 8,
+                  "Base layer decimation must be 1, 2, 4 or 8");
+
+    // Base grid: LED i follows grid point i >> shift (decimation 1 << shift)
+    static constexpr uint8_t BASE_SHIFT = (BASE_DECIMATION >= 8) ? 3 : (BASE_DECIMATION >= 4) ? 2 : (BASE_DECIMATION >= 2) ? 1 : 0;
+    static constexpr uint8_t MAX_BASE_SHIFT = 3;     // Coarsest grid: every 8th LED
+
+    // Grid points for a shift (a decimated grid has one past the last LED to blend toward)
+    static constexpr uint16_t gridPoints(uint8_t shift)
+    {
+        return (shift == 0) ? LEDS : ((LEDS - 1) >> shift) + 2;
+    }
+
+    // Quality levels: those of BaseLayerCore (0-3), then
+    //   4+: + base grid twice as coarse per level, up to MAX_BASE_SHIFT
+    static constexpr uint8_t QUALITY_COARSE_BASE = 4;
+
+    uint8_t qualityLevels() const override { return QUALITY_COARSE_BASE + MAX_BASE_SHIFT - BASE_SHIFT; }
+
+    void setQuality(uint8_t level) override
+    {
+        LayerCore::setQuality(level);
+        uint8_t coarser = (this->quality >= QUALITY_COARSE_BASE) ? this->quality - QUALITY_REDUCED_SPREAD : 0;
+        setBaseShift(BASE_SHIFT + coarser);
+    }
+
+    // Current base grid shift (decimation 1 << shift)
+    uint8_t getBaseShift() const { return baseShift; }
 
 protected:
-    // Per-LED base state (4 channels × MAX_LEDS)
-    int8_t hueOffset[4][MAX_LEDS];       // Current offset from channel hue (-ANGLE_WIDTH/2 to +ANGLE_WIDTH/2)
-    int8_t hueDir[4][MAX_LEDS];          // Last hue move direction: -1, 0, +1
-    uint8_t baseBrightness[4][MAX_LEDS]; // Current base brightness
-    int8_t brightDir[4][MAX_LEDS];       // Last brightness move direction: -1, 0, +1
-
-    // Derived classes implement these to define the harmony
-    virtual const int *getHarmonyOffsets() const = 0; // Hue offsets from primary (0°, ...)
-    virtual int getNumHarmonyHues() const = 0;        // Number of hues in harmony
-
-    // Pick a harmony color for overlay effects (runners, raindrops, etc.)
-    // Override in derived classes if needed (e.g., MonochromaticRunner/Rain)
-    virtual void pickHarmonyColor(int channelIndex, uint8_t &h, uint8_t &s, uint8_t &v)
+    using typename LayerCore::Palette;
+    using LayerCore::ANGLE_WIDTH;
+    using LayerCore::SMOOTHSTEP;
+    using LayerCore::palette;
+    using Base::BRIGHTNESS_KNOCK_ZERO_PCT;
+    using Base::markovTransition;
+    using Base::markovTransitionBrightnessBiased;
+
+    // Largest grid the animation uses (its finest shift, or a coarser one on very short strips)
+    static constexpr uint16_t maxGridPoints()
+    {
+        uint16_t most = 0;
+        for (uint8_t shift = BASE_SHIFT; shift <= MAX_BASE_SHIFT; shift++)
+        {
+            if (gridPoints(shift) > most)
+                most = gridPoints(shift);
+        }
+        return most;
+    }
+    static constexpr uint16_t BASE_POINTS = maxGridPoints();
+
+    // Per-grid-point base state (CHANNELS × BASE_POINTS; one point per LED at decimation 1)
+    int8_t hueOffset[CHANNELS][BASE_POINTS];       // Current offset from channel hue (-ANGLE_WIDTH/2 to +ANGLE_WIDTH/2)
+    int8_t hueDir[CHANNELS][BASE_POINTS];          // Last hue move direction: -1, 0, +1
+    uint8_t baseBrightness[CHANNELS][BASE_POINTS]; // Current base brightness
+    int8_t brightDir[CHANNELS][BASE_POINTS];       // Last brightness move direction: -1, 0, +1
+    uint8_t baseShift = BASE_SHIFT;                // Grid in use
+
+    // Reset the base state (all channels; any grid)
+    void resetBaseLayer()
+    {
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            for (int i = 0; i < BASE_POINTS; i++)
+            {
+                hueOffset[ch][i] = 0;
+                hueDir[ch][i] = 0;
+                baseBrightness[ch][i] = BASE_BRIGHTNESS;
+                brightDir[ch][i] = 0;
+            }
+        }
+    }
+
+    // Base color of LED i (upsampled from the grid when decimated)
+    CRGB baseColorAt(uint8_t ch, uint16_t i) const
     {
-        const int *offsets = getHarmonyOffsets();
-        int idx = random(getNumHarmonyHues());
-        int hue360 = (channelHue[channelIndex] + offsets[idx] + 360) % 360;
-        int spread = generateSpread();
-        hue360 = (hue360 + spread + 360) % 360;
-        h = map(hue360, 0, 360, 0, 255);
-        s = (offsets[idx] == 0) ? PRIMARY_HUE_SAT : 255; // Desaturate primary hue
-        v = 255;
+        if (baseShift == 0)
+            return palette[ch].color(Palette::baseIndex(hueOffset[ch][i]), baseBrightness[ch][i]);
+
+        uint16_t g = i >> baseShift;
+        int w = SMOOTHSTEP[(i & ((1 << baseShift) - 1)) << (MAX_BASE_SHIFT - baseShift)];
+        int hue = hueOffset[ch][g] + (((hueOffset[ch][g + 1] - hueOffset[ch][g]) * w + 128) >> 8);
+        int bright = baseBrightness[ch][g] + (((baseBrightness[ch][g + 1] - baseBrightness[ch][g]) * w + 128) >> 8);
+        return palette[ch].color(Palette::baseIndex(hue), bright);
     }
 
     // Update base layer undulations (called every frame by derived classes)
     void updateBaseLayer()
     {
-        for (int ch = 0; ch < 4; ch++)
+        for (int ch = 0; ch < CHANNELS; ch++)
         {
-            for (int i = 0; i < MAX_LEDS; i++)
+            updateBaseRange(ch, 0, MAX_LEDS);
+        }
+    }
+
+    // Update the undulations of LEDs [from, to) of one channel (one frame slice)
+    // On a decimated grid this steps the grid points in the range; the last
+    // slice of a channel also steps the point past the end.
+    void updateBaseRange(uint8_t ch, uint16_t from, uint16_t to)
+    {
+        uint16_t mask = (1 << baseShift) - 1;
+        uint16_t first = (from + mask) >> baseShift;
+        uint16_t last = (to >= MAX_LEDS) ? gridPoints(baseShift) : (to + mask) >> baseShift;
+        stepBasePoints(ch, first, last);
+    }
+
+private:
+    static_assert(MAX_BASE_SHIFT == LayerCore::SMOOTHSTEP_SHIFT, "Upsampling table covers the coarsest grid");
+
+    // Random walk of grid points [first, last) of one channel
+    void stepBasePoints(uint8_t ch, uint16_t first, uint16_t last)
+    {
+        for (int i = first; i < last; i++)
+        {
+            // Hue random walk
+            int8_t nextHueDir = markovTransition(hueDir[ch][i]);
+
+            // Limit bouncing: flip bias if at limits
+            if (hueOffset[ch][i] >= ANGLE_WIDTH / 2 && nextHueDir > 0)
+            {
+                nextHueDir = markovTransition(-1); // Treat as if moving negative
+            }
+            else if (hueOffset[ch][i] <= -ANGLE_WIDTH / 2 && nextHueDir < 0)
             {
-                // Hue random walk
-                int8_t nextHueDir = markovTransition(hueDir[ch][i]);
+                nextHueDir = markovTransition(1); // Treat as if moving positive
+            }
 
-                // Limit bouncing: flip bias if at limits
-                if (hueOffset[ch][i] >= ANGLE_WIDTH / 2 && nextHueDir > 0)
-                {
-                    nextHueDir = markovTransition(-1); // Treat as if moving negative
-                }
-                else if (hueOffset[ch][i] <= -ANGLE_WIDTH / 2 && nextHueDir < 0)
+            hueDir[ch][i] = nextHueDir;
+            hueOffset[ch][i] += nextHueDir;
+            hueOffset[ch][i] = constrain(hueOffset[ch][i], -ANGLE_WIDTH / 2, ANGLE_WIDTH / 2);
+
+            // Brightness random walk (biased towards brighter)
+            int8_t nextBrightDir = markovTransitionBrightnessBiased(brightDir[ch][i]);
+
+            // Limit bouncing at MAX with optional knock-to-zero effect
+            if (baseBrightness[ch][i] >= MAX_BRIGHTNESS && nextBrightDir > 0)
+            {
+                if (random(100) < BRIGHTNESS_KNOCK_ZERO_PCT)
                 {
-                    nextHueDir = markovTransition(1); // Treat as if moving positive
+                    baseBrightness[ch][i] = 0;
+                    brightDir[ch][i] = 0;
+                    continue; // Skip normal step+constrain
                 }
+                nextBrightDir = markovTransitionBrightnessBiased(-1);
+            }
+            else if (baseBrightness[ch][i] <= BASE_BRIGHTNESS && nextBrightDir < 0)
+            {
+                nextBrightDir = markovTransitionBrightnessBiased(1);
+            }
 
-                hueDir[ch][i] = nextHueDir;
-                hueOffset[ch][i] += nextHueDir;
-                hueOffset[ch][i] = constrain(hueOffset[ch][i], -ANGLE_WIDTH / 2, ANGLE_WIDTH / 2);
+            brightDir[ch][i] = nextBrightDir;
+            baseBrightness[ch][i] += nextBrightDir * 2; // Step by 2
+            baseBrightness[ch][i] = constrain(baseBrightness[ch][i], BASE_BRIGHTNESS, MAX_BRIGHTNESS);
+        }
+    }
 
-                // Brightness random walk (biased towards brighter)
-                int8_t nextBrightDir = markovTransitionBrightnessBiased(brightDir[ch][i]);
+    // Move the walk to another grid, keeping the picture: a coarser grid keeps
+    // every n-th point, a finer one fills in by linear interpolation (in place)
+    void setBaseShift(uint8_t shift)
+    {
+        if (shift > MAX_BASE_SHIFT)
+            shift = MAX_BASE_SHIFT;
+        if (shift == baseShift)
+            return;
 
-                // Limit bouncing at MAX with optional knock-to-zero effect
-                if (baseBrightness[ch][i] >= MAX_BRIGHTNESS && nextBrightDir > 0)
+        uint16_t oldPoints = gridPoints(baseShift);
+        uint16_t points = gridPoints(shift);
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            if (shift > baseShift)
+            {
+                uint8_t d = shift - baseShift;
+                for (uint16_t g = 0; g < points; g++)
                 {
-                    if (random(100) < BRIGHTNESS_KNOCK_ZERO_PCT)
-                    {
-                        baseBrightness[ch][i] = 0;
-                        brightDir[ch][i] = 0;
-                        continue; // Skip normal step+constrain
-                    }
-                    nextBrightDir = markovTransitionBrightnessBiased(-1);
+                    uint16_t src = (uint16_t)(g << d) < oldPoints ? g << d : oldPoints - 1;
+                    hueOffset[ch][g] = hueOffset[ch][src];
+                    hueDir[ch][g] = hueDir[ch][src];
+                    baseBrightness[ch][g] = baseBrightness[ch][src];
+                    brightDir[ch][g] = brightDir[ch][src];
                 }
-                else if (baseBrightness[ch][i] <= BASE_BRIGHTNESS && nextBrightDir < 0)
+            }
+            else
+            {
+                // Back to front: point g reads old points g >> d and the one after, both at or before g
+                uint8_t d = baseShift - shift;
+                for (int g = points - 1; g >= 0; g--)
                 {
-                    nextBrightDir = markovTransitionBrightnessBiased(1);
+                    uint16_t lo = g >> d;
+                    uint16_t frac = g & ((1 << d) - 1);
+                    if (frac != 0)
+                    {
+                        uint16_t hi = (lo + 1 < oldPoints) ? lo + 1 : lo;
+                        hueOffset[ch][g] = hueOffset[ch][lo] + (((hueOffset[ch][hi] - hueOffset[ch][lo]) * frac) >> d);
+                        baseBrightness[ch][g] = baseBrightness[ch][lo] + (((baseBrightness[ch][hi] - baseBrightness[ch][lo]) * frac) >> d);
+                    }
+                    else
+                    {
+                        hueOffset[ch][g] = hueOffset[ch][lo];
+                        baseBrightness[ch][g] = baseBrightness[ch][lo];
+                    }
+                    hueDir[ch][g] = hueDir[ch][lo];
+                    brightDir[ch][g] = brightDir[ch][lo];
                 }
-
-                brightDir[ch][i] = nextBrightDir;
-                baseBrightness[ch][i] += nextBrightDir * 2; // Step by 2
-                baseBrightness[ch][i] = constrain(baseBrightness[ch][i], BASE_BRIGHTNESS, MAX_BRIGHTNESS);
             }
         }
+        baseShift = shift;
     }
 };
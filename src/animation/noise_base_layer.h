@@ -0,0 +1,159 @@
+#pragma once
+
+#include "base_layer_core.h"
+
+// Noise-field base layer: an alternative to MarkovBaseLayer (same interface,
+// see BaseLayerCore)
+//
+// Base layer: All LEDs show channel's hue with smooth undulations, read from a
+// 1D value-noise field over (position, time) instead of a per-LED random walk
+//   - Lattice: one cell every 8 LEDs per channel; a cell's value at time t
+//     blends (smoothstep) between hashes of its two neighbouring time steps
+//   - Hue: ±ANGLE_WIDTH/2 around channel hue, new time step every HUE_PERIOD_MS
+//   - Brightness: BASE_BRIGHTNESS to MAX_BRIGHTNESS, every BRIGHTNESS_PERIOD_MS
+//   - LEDs between cells blend with the same smoothstep weights as the
+//     decimated Markov grid
+//
+// The field is a pure function of (seed, channel, LED, time): nothing is
+// carried from frame to frame except the clock, so the layer can seek to any
+// time (seekBaseLayer) and a frame costs the same wherever it is. Each frame
+// (or slice) samples the cells it needs into a small cache; the sampling loop
+// is branch-free integer arithmetic over an array. State is
+// 2 bytes per cell against 4 bytes per LED for the Markov walk.
+//
+// The clock advances by the frame interval every frame, including the frames
+// QUALITY_HALF_RATE_BASE skips, so lowering quality halves the sampling rate
+// but keeps the speed of the motion.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class NoiseBaseLayer : public BaseLayerCore<CHANNELS, LEDS>
+{
+public:
+    typedef BaseLayerCore<CHANNELS, LEDS> LayerCore;
+    typedef typename LayerCore::Base Base;
+    using Base::MAX_LEDS;
+    using LayerCore::BASE_BRIGHTNESS;
+    using LayerCore::MAX_BRIGHTNESS;
+
+    static constexpr uint8_t CELL_SHIFT = 3;                      // One lattice cell every 8 LEDs
+    static constexpr uint16_t CELLS = ((LEDS - 1) >> CELL_SHIFT) + 2; // Plus one past the last LED to blend toward
+    static constexpr uint32_t HUE_PERIOD_MS = 4000;               // Time between hue lattice steps
+    static constexpr uint32_t BRIGHTNESS_PERIOD_MS = 2000;        // Time between brightness lattice steps
+
+    // Move the field to time ms (since reset) and resample it
+    void seekBaseLayer(uint32_t ms)
+    {
+        baseTimeMs = ms;
+        sampleAll();
+    }
+
+    uint32_t getBaseTimeMs() const { return baseTimeMs; }
+
+protected:
+    using typename LayerCore::Palette;
+    using LayerCore::ANGLE_WIDTH;
+    using LayerCore::SMOOTHSTEP;
+    using LayerCore::palette;
+
+    static_assert(CELL_SHIFT == LayerCore::SMOOTHSTEP_SHIFT, "Upsampling table spans one cell");
+
+    // Field samples at the cells for the current time (a cache, not state)
+    uint8_t hueCell[CHANNELS][CELLS];
+    uint8_t brightCell[CHANNELS][CELLS];
+    uint32_t baseTimeMs = 0;
+    uint32_t noiseSeed = 0;
+
+    // New field (random seed) at time 0
+    void resetBaseLayer()
+    {
+        noiseSeed = random(0x7FFFFFFF);
+        seekBaseLayer(0);
+    }
+
+    // Advance the clock one frame, then decide whether this frame samples
+    void beginBaseFrame()
+    {
+        baseTimeMs += this->frameIntervalMs();
+        LayerCore::beginBaseFrame();
+    }
+
+    // Base color of LED i (smoothstep between its two cells)
+    CRGB baseColorAt(uint8_t ch, uint16_t i) const
+    {
+        return palette[ch].color(Palette::baseIndex(baseHueAt(ch, i)), baseBrightnessAt(ch, i));
+    }
+
+    // Hue offset (-ANGLE_WIDTH/2 to +ANGLE_WIDTH/2) and brightness of LED i
+    int baseHueAt(uint8_t ch, uint16_t i) const
+    {
+        return ((upsample(hueCell[ch], i) * (ANGLE_WIDTH + 1)) >> 8) - ANGLE_WIDTH / 2;
+    }
+
+    uint8_t baseBrightnessAt(uint8_t ch, uint16_t i) const
+    {
+        return BASE_BRIGHTNESS + ((upsample(brightCell[ch], i) * (MAX_BRIGHTNESS - BASE_BRIGHTNESS)) >> 8);
+    }
+
+    // Sample the field for every channel (called every frame by derived classes)
+    void updateBaseLayer()
+    {
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            updateBaseRange(ch, 0, MAX_LEDS);
+        }
+    }
+
+    // Sample the cells LEDs [from, to) of one channel blend between (one frame slice)
+    void updateBaseRange(uint8_t ch, uint16_t from, uint16_t to)
+    {
+        uint16_t first = from >> CELL_SHIFT;
+        uint16_t last = (to >= MAX_LEDS) ? CELLS : ((to - 1) >> CELL_SHIFT) + 2;
+        sampleCells(hueCell[ch], ch, first, last, HUE_PERIOD_MS, noiseSeed);
+        sampleCells(brightCell[ch], ch, first, last, BRIGHTNESS_PERIOD_MS, noiseSeed ^ BRIGHTNESS_SALT);
+    }
+
+private:
+    static constexpr uint32_t BRIGHTNESS_SALT = 0x5BD1E995; // Decorrelates the brightness field from hue
+
+    // Integer hash of a lattice point to 0-255
+    static uint8_t hash8(uint32_t x, uint32_t t, uint32_t seed)
+    {
+        uint32_t h = x * 0x9E3779B1u ^ t * 0x85EBCA77u ^ seed;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        h *= 0x297A2D39u;
+        h ^= h >> 15;
+        return h >> 24;
+    }
+
+    // Value of cells [first, last) of a channel at the current time
+    void sampleCells(uint8_t *cells, uint8_t ch, uint16_t first, uint16_t last, uint32_t periodMs, uint32_t seed) const
+    {
+        uint32_t step = baseTimeMs / periodMs;
+        uint32_t f = (baseTimeMs % periodMs) * 256 / periodMs;   // 0-255
+        int s = (f * f * (768 - 2 * f)) >> 16;                   // Smoothstep, 0-255
+        uint32_t row = (uint32_t)ch * CELLS;
+        for (uint16_t c = first; c < last; c++)
+        {
+            int a = hash8(row + c, step, seed);
+            int b = hash8(row + c, step + 1, seed);
+            cells[c] = a + (((b - a) * s) >> 8);
+        }
+    }
+
+    void sampleAll()
+    {
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            updateBaseRange(ch, 0, MAX_LEDS);
+        }
+    }
+
+    // Value at LED i, smoothstep between its cell and the next (0-255)
+    static int upsample(const uint8_t *cells, uint16_t i)
+    {
+        uint16_t c = i >> CELL_SHIFT;
+        int w = SMOOTHSTEP[i & ((1 << CELL_SHIFT) - 1)];
+        return cells[c] + (((cells[c + 1] - cells[c]) * w + 128) >> 8);
+    }
+};
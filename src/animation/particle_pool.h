@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../fixed_point.h"
+
+// Fixed-capacity particle pool (runners, raindrops, comets, sparks...)
+//
+// Slots are tracked in an occupancy bitmask: allocation takes the lowest free
+// bit (count trailing zeros), counting is a popcount and iteration visits only
+// set bits, so none of them scans the slots. Fields are stored as parallel
+// arrays (SoA) indexed by slot; an effect uses the ones it needs:
+//
+//   pos       Q16.16 position in LEDs (head, center...)
+//   velocity  Q8.8 pixels per frame
+//   age       frames since spawn
+//   color     palette index
+//
+// A slot's fields are whatever the effect last wrote: allocate() does not clear them.
+template <uint8_t CAPACITY>
+class ParticlePool {
+public:
+    static_assert(CAPACITY > 0 && CAPACITY <= 32, "Particle pool holds 1 to 32 slots");
+
+    static constexpr int8_t NONE = -1;
+
+    Q16_16 pos[CAPACITY];
+    Q8_8 velocity[CAPACITY];
+    uint8_t age[CAPACITY];
+    uint8_t color[CAPACITY];
+
+    ParticlePool() : occupied(0) {}
+
+    void clear() { occupied = 0; }
+
+    // Lowest free slot, marked used; NONE when full
+    int8_t allocate() {
+        uint32_t free = ~occupied & ALL;
+        if (free == 0) return NONE;
+        uint8_t slot = __builtin_ctz(free);
+        occupied |= 1UL << slot;
+        return slot;
+    }
+
+    void release(uint8_t slot) { occupied &= ~(1UL << slot); }
+
+    bool active(uint8_t slot) const { return occupied & (1UL << slot); }
+    uint8_t count() const { return __builtin_popcount(occupied); }
+    bool full() const { return occupied == ALL; }
+    uint32_t mask() const { return occupied; }
+
+    // fn(slot) for every active slot, lowest first (fn may release its slot)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        uint32_t bits = occupied;
+        while (bits) {
+            uint8_t slot = __builtin_ctz(bits);
+            bits &= bits - 1;
+            fn(slot);
+        }
+    }
+
+    // First active slot (lowest) for which pred(slot) holds; NONE if none
+    template <typename Pred>
+    int8_t find(Pred pred) const {
+        uint32_t bits = occupied;
+        while (bits) {
+            uint8_t slot = __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (pred(slot)) return slot;
+        }
+        return NONE;
+    }
+
+private:
+    static constexpr uint32_t ALL = (CAPACITY == 32) ? 0xFFFFFFFFUL : (1UL << CAPACITY) - 1;
+    uint32_t occupied;
+};
+
+// One bit per LED of a channel: which LEDs some particle covers
+//
+// Spawn collision tests become a range test over a few words instead of a
+// scan of every particle, and rendering skips the particle lookup for LEDs
+// whose bit is clear. Ranges are inclusive and clipped to the strip.
+template <uint16_t LEDS>
+class OccupancyMap {
+public:
+    static constexpr uint16_t WORDS = (LEDS + 31) / 32;
+
+    OccupancyMap() { clear(); }
+
+    void clear() {
+        for (uint16_t w = 0; w < WORDS; w++) bits[w] = 0;
+    }
+
+    void mark(int16_t from, int16_t to) { apply(from, to, true); }
+    void unmark(int16_t from, int16_t to) { apply(from, to, false); }
+
+    bool test(uint16_t i) const { return bits[i / 32] & (1UL << (i % 32)); }
+
+    // Any LED in [from, to] covered
+    bool any(int16_t from, int16_t to) const {
+        if (!clip(from, to)) return false;
+        uint16_t first = from / 32, last = to / 32;
+        for (uint16_t w = first; w <= last; w++) {
+            uint32_t m = wordMask(w, from, to);
+            if (bits[w] & m) return true;
+        }
+        return false;
+    }
+
+private:
+    uint32_t bits[WORDS];
+
+    static bool clip(int16_t& from, int16_t& to) {
+        if (from < 0) from = 0;
+        if (to >= (int16_t)LEDS) to = LEDS - 1;
+        return from <= to;
+    }
+
+    // Bits of word w that fall inside [from, to]
+    static uint32_t wordMask(uint16_t w, int16_t from, int16_t to) {
+        uint16_t lo = (w * 32 > (uint16_t)from) ? 0 : from - w * 32;
+        uint16_t hi = (w * 32 + 31 < (uint16_t)to) ? 31 : to - w * 32;
+        uint32_t upper = (hi == 31) ? 0xFFFFFFFFUL : (1UL << (hi + 1)) - 1;
+        return upper & ~((1UL << lo) - 1);
+    }
+
+    void apply(int16_t from, int16_t to, bool set) {
+        if (!clip(from, to)) return;
+        for (uint16_t w = from / 32; w <= to / 32; w++) {
+            uint32_t m = wordMask(w, from, to);
+            bits[w] = set ? (bits[w] | m) : (bits[w] & ~m);
+        }
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Adaptive quality governor
+// Watches the measured time of each animation frame (start to commit, so time
+// taken by HomeSpan, WiFi and the other loop tasks counts too) and moves the
+// animation through its quality levels (AnimationBase::qualityLevels()):
+//
+//   - Degrade: when the smoothed frame time exceeds the budget, step one level
+//     down in detail, then wait SETTLE_FRAMES for the average to reflect it.
+//   - Recover: after RECOVER_FRAMES frames in a row under RECOVER_PCT of the
+//     budget, step one level back up. The gap between the two thresholds and
+//     the long recovery window keep it from flapping between levels.
+//
+// The frame time average is an exponential moving average (1/4 weight).
+class QualityGovernor {
+public:
+    static constexpr uint8_t SETTLE_FRAMES = 4;     // Frames after a step before judging again
+    static constexpr uint8_t RECOVER_FRAMES = 40;   // Frames under the recovery threshold (2 s at 20 fps)
+    static constexpr uint8_t RECOVER_PCT = 60;      // Recovery threshold (% of budget)
+
+    explicit QualityGovernor(uint32_t budgetUs) :
+        budgetUs(budgetUs), levels(1), current(0), averageUs(0), settle(0), underCount(0) {}
+
+    // New animation: start at full detail with its number of levels
+    void reset(uint8_t levels) {
+        this->levels = levels ? levels : 1;
+        current = 0;
+        averageUs = 0;
+        settle = 0;
+        underCount = 0;
+    }
+
+    // Feed one frame's measured time; returns the level for the next frame
+    uint8_t update(uint32_t frameUs) {
+        averageUs = (averageUs == 0) ? frameUs : averageUs + ((int32_t)frameUs - (int32_t)averageUs) / 4;
+
+        if (settle > 0) {
+            settle--;
+            return current;
+        }
+
+        if (averageUs > budgetUs) {
+            underCount = 0;
+            if (current + 1 < levels) step(current + 1);
+        } else if (averageUs < budgetUs * RECOVER_PCT / 100) {
+            if (++underCount >= RECOVER_FRAMES) {
+                underCount = 0;
+                if (current > 0) step(current - 1);
+            }
+        } else {
+            underCount = 0;
+        }
+        return current;
+    }
+
+    uint8_t level() const { return current; }
+    uint32_t averageFrameUs() const { return averageUs; }
+    uint32_t getBudgetUs() const { return budgetUs; }
+
+private:
+    uint32_t budgetUs;
+    uint8_t levels;
+    uint8_t current;
+    uint32_t averageUs;
+    uint8_t settle;             // Frames left before the next decision
+    uint8_t underCount;         // Consecutive frames under the recovery threshold
+
+    void step(uint8_t level) {
+        current = level;
+        settle = SETTLE_FRAMES;
+    }
+};
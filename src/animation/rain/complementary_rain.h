@@ -3,19 +3,13 @@
 #include "rain_base.h"
 
 // Complementary rain animation: primary hue + opposite (180°)
-class ComplementaryRain : public RainAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class ComplementaryRain : public RainAnimationBase<ComplementaryRain<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Complementary Rain";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 180};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 2;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 180};
 };
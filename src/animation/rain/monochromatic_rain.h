@@ -3,19 +3,13 @@
 #include "rain_base.h"
 
 // Monochromatic rain animation: primary hue (white via PRIMARY_HUE_SAT=0)
-class MonochromaticRain : public RainAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class MonochromaticRain : public RainAnimationBase<MonochromaticRain<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Monochromatic Rain";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 1;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0};
 };
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../markov_base_layer.h"
-#include <math.h>
+#include "../noise_base_layer.h"
+#include "../gaussian_blend.h"
+#include "../particle_pool.h"
 
 // Base class for all harmony-based rain animations
 //
@@ -9,6 +11,7 @@
 //   - Hue: ±ANGLE_WIDTH/2 around channel hue, using Markov chain
 //   - Brightness: BASE_BRIGHTNESS to MAX_BRIGHTNESS, using Markov chain
 //   - Markov chain has momentum (60% chance to continue current direction)
+//   - Or a noise field over (position, time) with NoiseBaseLayer (see below)
 //
 // Raindrop layer: Random stationary "raindrops" fade in/out using time-varying Gaussian blend
 //   - Raindrop count: 1 (at brightness=100) to 6 (at brightness=0)
@@ -16,123 +19,100 @@
 //   - Lifecycle: RAINDROP_MAX_FRAMES frames
 //   - Gaussian variance: 0.1 (frame 0) → 10.0 (frame MAX) for fade effect
 //   - Spawn: Random non-colliding positions
+//   - Raindrops live in a per-channel ParticlePool (pos = center, age = lifecycle
+//     frame); an OccupancyMap of the LEDs they cover answers collision tests and
+//     lets rendering skip uncovered LEDs
 //
-// Derived classes implement getHarmonyOffsets(), getNumHarmonyHues(), getName()
-class RainAnimationBase : public MarkovBaseLayer
+// RainAnimationCore holds the harmony-independent state and kernels (compiled once);
+// RainAnimationBase<Derived> binds the leaf's harmony at compile time (see below)
+template <uint8_t CHANNELS, uint16_t LEDS, typename BaseLayer = MarkovBaseLayer<CHANNELS, LEDS>>
+class RainAnimationCore : public BaseLayer
 {
 public:
-    // Tunable parameters (MAX_LEDS, FRAME_MS, ANGLE_WIDTH, BASE_BRIGHTNESS, MAX_BRIGHTNESS inherited from MarkovBaseLayer)
+    typedef BaseLayer Layer;
+    using typename Layer::Base;
+    using Layer::MAX_LEDS;
+    using Layer::BASE_BRIGHTNESS;
+
+    // Tunable parameters (MAX_LEDS, FRAME_MS, ANGLE_WIDTH, BASE_BRIGHTNESS, MAX_BRIGHTNESS inherited from the base layer)
     static constexpr uint8_t RAINDROP_LENGTH = 11;   // LEDs per raindrop (must be odd)
     static constexpr uint8_t RAINDROP_MAX_FRAMES = 30; // 1.5s lifecycle
-    static constexpr float MIN_GAUSSIAN_VARIANCE = 0.1f; // Frame 0 (concentrated)
-    static constexpr float MAX_GAUSSIAN_VARIANCE = 10.0f; // Frame MAX (diffuse)
+    static constexpr Q16_16 MIN_GAUSSIAN_VARIANCE = Q16_16::fromRatio(1, 10); // Frame 0 (concentrated)
+    static constexpr Q16_16 MAX_GAUSSIAN_VARIANCE = Q16_16::fromInt(10);      // Frame MAX (diffuse)
     static constexpr uint8_t MIN_RAINDROPS = 6;      // At brightness=100
     static constexpr uint8_t MAX_RAINDROPS = 18;     // At brightness=0
     static constexpr uint8_t MAX_RAINDROP_SLOTS = 18; // Per channel
     static constexpr uint8_t MAX_SPAWN_ATTEMPTS = 10; // Collision retry limit
+    static constexpr int16_t RAINDROP_HALF = RAINDROP_LENGTH / 2;
 
-    struct Raindrop
-    {
-        int16_t centerPos;  // Center position on strip
-        uint8_t currentFrame; // Lifecycle frame (0 to MAX_FRAMES)
-        uint8_t hue;        // FastLED hue (0-255)
-        uint8_t sat;        // Saturation (255 for harmony, 0 for white/black)
-        uint8_t val;        // Value (255 normally, 0 for black)
-        bool active;        // Currently alive?
-    };
+    typedef ParticlePool<MAX_RAINDROP_SLOTS> RaindropPool;
 
-    RainAnimationBase()
+    RainAnimationCore()
     {
         reset();
     }
 
-    // Set channel hues (called by manager when animation starts or hue changes)
-    void setChannelHues(int h1, int h2, int h3, int h4) override
-    {
-        AnimationBase::setChannelHues(h1, h2, h3, h4);
-    }
-
-    // Set channel brightnesses (affects raindrop count)
-    void setChannelBrightnesses(int b1, int b2, int b3, int b4) override
-    {
-        AnimationBase::setChannelBrightnesses(b1, b2, b3, b4);
-    }
-
     void begin() override
     {
         reset();
     }
 
-    bool update(unsigned long deltaMs) override
+    void render(CRGB *const channels[CHANNELS]) override
     {
-        frameAccumulator += deltaMs;
-
-        if (frameAccumulator >= FRAME_MS)
+        for (uint8_t ch = 0; ch < CHANNELS; ch++)
         {
-            frameAccumulator -= FRAME_MS;
-            updateBaseLayer();
-            updateRaindrops();
-            return true; // Update needed
+            renderRange(channels[ch], ch, 0, MAX_LEDS);
         }
+    }
 
-        return false; // No update needed yet
+    // Sliced frames: each slice steps and renders SLICE_LEDS LEDs of one channel
+    bool beginFrame(unsigned long deltaMs) override
+    {
+        if (!this->advanceFrame(deltaMs))
+            return false;
+        this->beginBaseFrame();
+        return true;
     }
 
-    void render(CRGB *ch1, CRGB *ch2, CRGB *ch3, CRGB *ch4, uint16_t numLeds) override
+    uint16_t frameSlices() const override
     {
-        renderChannel(ch1, numLeds, 0);
-        renderChannel(ch2, numLeds, 1);
-        renderChannel(ch3, numLeds, 2);
-        renderChannel(ch4, numLeds, 3);
+        return Base::FRAME_SLICES;
     }
 
     void reset() override
     {
-        // Initialize base layer state
-        for (int ch = 0; ch < 4; ch++)
+        this->resetBaseLayer();
+        for (int ch = 0; ch < CHANNELS; ch++)
         {
-            for (int i = 0; i < MAX_LEDS; i++)
-            {
-                hueOffset[ch][i] = 0;
-                hueDir[ch][i] = 0;
-                baseBrightness[ch][i] = BASE_BRIGHTNESS;
-                brightDir[ch][i] = 0;
-            }
             cachedBrightness[ch] = 100; // Default to full brightness
-
-            // Deactivate all raindrops
-            for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
-            {
-                raindrops[ch][r].active = false;
-                raindrops[ch][r].currentFrame = 0;
-                raindrops[ch][r].centerPos = 0;
-            }
+            raindrops[ch].clear();
+            covered[ch].clear();
             framesSinceSpawn[ch] = 0;
         }
         frameAccumulator = 0;
     }
 
 protected:
+    using typename Layer::Palette;
+    using Layer::baseColorAt;
+    using Layer::palette;
+    using Layer::cachedBrightness;
+    using Layer::frameAccumulator;
+
     // Raindrop state
-    Raindrop raindrops[4][MAX_RAINDROP_SLOTS]; // Per channel
-    uint16_t framesSinceSpawn[4];              // Per channel, for spawn probability
+    RaindropPool raindrops[CHANNELS];       // Per channel
+    OccupancyMap<MAX_LEDS> covered[CHANNELS]; // LEDs under a raindrop, per channel
+    uint16_t framesSinceSpawn[CHANNELS];    // Per channel, for spawn probability
 
-private:
-    // Check if position collides with any active raindrop
+    // Raindrop blend factors by [lifecycle frame][distance from center]
+    static constexpr auto raindropBlendLUT = makeFadingGaussianLut<RAINDROP_MAX_FRAMES, RAINDROP_LENGTH / 2>(
+        MIN_GAUSSIAN_VARIANCE.toDouble(), MAX_GAUSSIAN_VARIANCE.toDouble());
+
+    // Check if position collides with any active raindrop (closer than RAINDROP_LENGTH)
+    // Two drops that close overlap, so this is a test of the LEDs the new one would cover
     bool checkCollision(int channelIndex, int16_t pos)
     {
-        for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
-        {
-            if (raindrops[channelIndex][r].active)
-            {
-                int16_t distance = abs(pos - raindrops[channelIndex][r].centerPos);
-                if (distance < RAINDROP_LENGTH)
-                {
-                    return true; // Collision detected
-                }
-            }
-        }
-        return false; // No collision
+        return covered[channelIndex].any(pos - RAINDROP_HALF, pos + RAINDROP_HALF);
     }
 
     // Find a random non-colliding spawn position
@@ -150,128 +130,91 @@ private:
         return false; // Failed to find position after max attempts
     }
 
-    // Update raindrops (aging and spawning)
-    void updateRaindrops()
+    // Update one channel's raindrops (aging and spawning)
+    // Returns the slot of the raindrop spawned this frame (or RaindropPool::NONE);
+    // its color is picked by the harmony layer
+    int8_t updateRaindrops(int ch)
     {
-        for (int ch = 0; ch < 4; ch++)
-        {
-            // Age existing raindrops
-            for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
-            {
-                if (raindrops[ch][r].active)
-                {
-                    raindrops[ch][r].currentFrame++;
+        RaindropPool &drops = raindrops[ch];
+        int8_t spawned = RaindropPool::NONE;
 
-                    // Deactivate if lifecycle complete
-                    if (raindrops[ch][r].currentFrame >= RAINDROP_MAX_FRAMES)
-                    {
-                        raindrops[ch][r].active = false;
-                    }
-                }
+        // Age existing raindrops, removing those whose lifecycle is complete
+        drops.forEach([&](uint8_t r) {
+            if (++drops.age[r] >= RAINDROP_MAX_FRAMES)
+            {
+                int16_t center = drops.pos[r].toInt();
+                covered[ch].unmark(center - RAINDROP_HALF, center + RAINDROP_HALF);
+                drops.release(r);
             }
+        });
 
-            framesSinceSpawn[ch]++;
+        framesSinceSpawn[ch]++;
 
-            // Calculate max raindrops based on brightness (inverted: low brightness = more raindrops)
-            int maxRaindrops = MAX_RAINDROPS - (cachedBrightness[ch] * (MAX_RAINDROPS - MIN_RAINDROPS)) / 100;
+        // Calculate max raindrops based on brightness (inverted: low brightness = more raindrops)
+        int maxRaindrops = MAX_RAINDROPS - (cachedBrightness[ch] * (MAX_RAINDROPS - MIN_RAINDROPS)) / 100;
+        if (this->quality >= Layer::QUALITY_FEWER_OVERLAYS)
+            maxRaindrops = (maxRaindrops + 1) / 2;
 
-            // Count active raindrops
-            int activeCount = 0;
-            for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
-            {
-                if (raindrops[ch][r].active)
-                    activeCount++;
-            }
+        if (drops.count() < maxRaindrops)
+        {
+            // Calculate spawn chance
+            int targetSpawnInterval = (MAX_LEDS + RAINDROP_LENGTH) / maxRaindrops;
+            int spawnChance = (framesSinceSpawn[ch] * 100) / targetSpawnInterval;
+            if (spawnChance > 100)
+                spawnChance = 100;
 
-            if (activeCount < maxRaindrops)
+            if (random(100) < spawnChance)
             {
-                // Calculate spawn chance
-                int targetSpawnInterval = (MAX_LEDS + RAINDROP_LENGTH) / maxRaindrops;
-                int spawnChance = (framesSinceSpawn[ch] * 100) / targetSpawnInterval;
-                if (spawnChance > 100)
-                    spawnChance = 100;
-
-                if (random(100) < spawnChance)
+                // Try to spawn a new raindrop
+                int16_t spawnPos;
+                if (findSpawnPosition(ch, spawnPos))
                 {
-                    // Try to spawn a new raindrop
-                    int16_t spawnPos;
-                    if (findSpawnPosition(ch, spawnPos))
+                    spawned = drops.allocate();
+                    if (spawned != RaindropPool::NONE)
                     {
-                        for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
-                        {
-                            if (!raindrops[ch][r].active)
-                            {
-                                raindrops[ch][r].centerPos = spawnPos;
-                                raindrops[ch][r].currentFrame = 0;
-                                pickHarmonyColor(ch, raindrops[ch][r].hue, raindrops[ch][r].sat, raindrops[ch][r].val);
-                                raindrops[ch][r].active = true;
-                                framesSinceSpawn[ch] = 0;
-                                break;
-                            }
-                        }
+                        drops.pos[spawned] = Q16_16::fromInt(spawnPos);
+                        drops.age[spawned] = 0;
+                        covered[ch].mark(spawnPos - RAINDROP_HALF, spawnPos + RAINDROP_HALF);
+                        framesSinceSpawn[ch] = 0;
                     }
                 }
             }
         }
+
+        return spawned;
     }
 
-    // Compute Gaussian blend factor for a raindrop at a given position
-    // Uses time-varying variance based on raindrop's current frame
-    uint8_t computeRaindropBlend(const Raindrop &drop, int16_t ledPos)
+    // Gaussian blend factor for raindrop r of a channel at a given position
+    // Time-varying variance and fade come from a compile-time table
+    uint8_t computeRaindropBlend(const RaindropPool &drops, uint8_t r, int16_t ledPos)
     {
-        // Calculate distance from raindrop center
-        float x = (float)(ledPos - drop.centerPos);
-
-        // Calculate time-varying variance (0.1 → 10.0 over lifecycle)
-        float frameProgress = drop.currentFrame / (float)RAINDROP_MAX_FRAMES;
-        float variance = MIN_GAUSSIAN_VARIANCE + frameProgress * (MAX_GAUSSIAN_VARIANCE - MIN_GAUSSIAN_VARIANCE);
-
-        // Gaussian spatial factor
-        float spatialFactor = expf(-(x * x) / (2.0f * variance));
-
-        // Temporal decay factor (fade over lifetime)
-        float temporalFactor = 1.0f - frameProgress;
-
-        // Combined blend factor
-        float blendFactor = spatialFactor * temporalFactor;
-
-        return (uint8_t)constrain((int)(blendFactor * 255.0f + 0.5f), 0, 255);
+        return raindropBlendLUT[drops.age[r]][abs(ledPos - drops.pos[r].toInt())];
     }
 
-    // Render a single channel
-    void renderChannel(CRGB *leds, uint16_t numLeds, uint8_t channelIndex)
+    // Render LEDs [from, to) of a single channel
+    void renderRange(CRGB *leds, uint8_t channelIndex, uint16_t from, uint16_t to)
     {
-        for (int i = 0; i < numLeds; i++)
+        for (int i = from; i < to; i++)
         {
-            // Compute base color
-            int hue360 = (channelHue[channelIndex] + hueOffset[channelIndex][i] + 360) % 360;
-            uint8_t hue8 = map(hue360, 0, 360, 0, 255);
-            CRGB baseColor = CHSV(hue8, 255, baseBrightness[channelIndex][i]);
+            // Base color: palette lookup scaled by the undulating brightness
+            CRGB baseColor = baseColorAt(channelIndex, i);
 
-            // Check if any raindrop covers this LED
+            // Check if any raindrop covers this LED (raindrops never overlap)
             CRGB finalColor = baseColor;
 
-            for (int r = 0; r < MAX_RAINDROP_SLOTS; r++)
+            if (covered[channelIndex].test(i))
             {
-                if (!raindrops[channelIndex][r].active)
-                    continue;
-
-                const Raindrop &drop = raindrops[channelIndex][r];
-                int16_t halfLen = RAINDROP_LENGTH / 2;
-                int16_t minPos = drop.centerPos - halfLen;
-                int16_t maxPos = drop.centerPos + halfLen;
-
-                // Check if LED is within raindrop range
-                if (i >= minPos && i <= maxPos)
+                const RaindropPool &drops = raindrops[channelIndex];
+                int8_t r = drops.find([&](uint8_t slot) {
+                    return abs(i - drops.pos[slot].toInt()) <= RAINDROP_HALF;
+                });
+                if (r != RaindropPool::NONE)
                 {
-                    // This LED is in this raindrop
-                    CRGB raindropColor = CHSV(drop.hue, drop.sat, drop.val);
+                    const CRGB &raindropColor = palette[channelIndex].entry(drops.color[r]);
 
                     // Calculate blend amount using time-varying Gaussian
-                    uint8_t blendFactor = computeRaindropBlend(drop, i);
+                    uint8_t blendFactor = computeRaindropBlend(drops, r, i);
                     finalColor = blend(baseColor, raindropColor, blendFactor);
-
-                    break; // Only apply first raindrop found
                 }
             }
 
@@ -279,3 +222,69 @@ private:
         }
     }
 };
+
+// Harmony layer: a leaf passes itself as Derived (CRTP) and provides getName() and
+// a public static constexpr int HARMONY_OFFSETS[] (hue offsets from primary).
+// Only palette building and the spawn color pick depend on the harmony.
+// A leaf may also pass its base layer engine: MarkovBaseLayer (the default) with a
+// decimation of 2, 4 or 8, or the stateless NoiseBaseLayer (see BaseLayerCore).
+template <typename Derived, uint8_t CHANNELS, uint16_t LEDS, typename BaseLayer = MarkovBaseLayer<CHANNELS, LEDS>>
+class RainAnimationBase : public RainAnimationCore<CHANNELS, LEDS, BaseLayer>
+{
+public:
+    typedef RainAnimationCore<CHANNELS, LEDS, BaseLayer> Core;
+    using typename Core::RaindropPool;
+
+    RainAnimationBase()
+    {
+        rebuildPalettes();
+    }
+
+    // Rebuild palettes for the new hues (LED state is palette-relative)
+    void setChannelHues(const int hues[CHANNELS]) override
+    {
+        Core::setChannelHues(hues);
+        rebuildPalettes();
+    }
+
+    bool update(unsigned long deltaMs) override
+    {
+        if (!this->advanceFrame(deltaMs))
+            return false; // No update needed yet
+
+        this->beginBaseFrame();
+        if (this->baseStepDue)
+            this->updateBaseLayer();
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            updateOverlay(ch);
+        }
+        return true; // Update needed
+    }
+
+    void computeSlice(uint16_t slice, CRGB *const channels[CHANNELS]) override
+    {
+        typename Core::SliceRange range = Core::sliceRange(slice);
+        if (this->baseStepDue)
+            this->updateBaseRange(range.channel, range.from, range.to);
+        if (range.from == 0)
+            updateOverlay(range.channel); // Raindrops step with the channel's first slice
+        this->renderRange(channels[range.channel], range.channel, range.from, range.to);
+    }
+
+private:
+    void updateOverlay(int ch)
+    {
+        int8_t spawned = this->updateRaindrops(ch);
+        if (spawned != RaindropPool::NONE)
+            this->raindrops[ch].color[spawned] = this->pickHarmonyColor(Derived::HARMONY_OFFSETS);
+    }
+
+    void rebuildPalettes()
+    {
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            this->palette[ch].build(this->channelHue[ch], Derived::HARMONY_OFFSETS, Core::PRIMARY_HUE_SAT);
+        }
+    }
+};
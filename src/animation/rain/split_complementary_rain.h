@@ -3,19 +3,13 @@
 #include "rain_base.h"
 
 // Split-complementary rain animation: primary hue + two adjacent to opposite
-class SplitComplementaryRain : public RainAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SplitComplementaryRain : public RainAnimationBase<SplitComplementaryRain<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Split-Complementary Rain";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 150, 210};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 150, 210};
 };
@@ -3,19 +3,13 @@
 #include "rain_base.h"
 
 // Square rain animation: four evenly spaced colors (0°, 90°, 180°, 270°)
-class SquareRain : public RainAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SquareRain : public RainAnimationBase<SquareRain<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Square Rain";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 90, 180, 270};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 4;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 90, 180, 270};
 };
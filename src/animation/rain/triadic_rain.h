@@ -3,19 +3,13 @@
 #include "rain_base.h"
 
 // Triadic rain animation: three evenly spaced colors (0°, 120°, 240°)
-class TriadicRain : public RainAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class TriadicRain : public RainAnimationBase<TriadicRain<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Triadic Rain";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 120, 240};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 120, 240};
 };
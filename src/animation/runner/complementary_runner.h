@@ -3,19 +3,13 @@
 #include "runner_base.h"
 
 // Complementary runner animation: uses primary hue and its opposite (180°)
-class ComplementaryRunner : public RunnerAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class ComplementaryRunner : public RunnerAnimationBase<ComplementaryRunner<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Complementary Runner";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 180};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 2;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 180};
 };
@@ -3,19 +3,13 @@
 #include "runner_base.h"
 
 // Monochromatic runner animation: primary hue (white via PRIMARY_HUE_SAT=0)
-class MonochromaticRunner : public RunnerAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class MonochromaticRunner : public RunnerAnimationBase<MonochromaticRunner<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Monochromatic Runner";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 1;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0};
 };
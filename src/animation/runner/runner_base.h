@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../markov_base_layer.h"
+#include "../noise_base_layer.h"
 #include "../gaussian_blend.h"
+#include "../particle_pool.h"
 
 // Base class for all harmony-based runner animations
 //
@@ -9,230 +11,211 @@
 //   - Hue: ±ANGLE_WIDTH/2 around channel hue, using Markov chain
 //   - Brightness: BASE_BRIGHTNESS to MAX_BRIGHTNESS, using Markov chain
 //   - Markov chain has momentum (60% chance to continue current direction)
+//   - Or a noise field over (position, time) with NoiseBaseLayer (see below)
 //
 // Runner layer: Groups of LEDs travel from position 0 to end, colored by harmony
 //   - Runner count: 1 (at brightness=0) to 4 (at brightness=100)
 //   - Length: RUNNER_LENGTH LEDs
 //   - Gaussian blending: Bell curve blend between base and runner colors
+//   - Sub-pixel motion: fixed-point position and velocity, RUNNER_SPEED pixels
+//     per second at any frame rate; the blob is sampled at its fractional
+//     position (SUBPIXEL_PHASES steps per pixel), so motion stays smooth
+//   - Runners live in a per-channel ParticlePool (pos = head, velocity); an
+//     OccupancyMap of the LEDs they cover, rebuilt as they move, gives the
+//     spawn test (pixel 0 clear) and lets rendering skip uncovered LEDs
 //
-// Derived classes implement getHarmonyOffsets(), getNumHarmonyHues(), getName()
-class RunnerAnimationBase : public MarkovBaseLayer
+// RunnerAnimationCore holds the harmony-independent state and kernels (compiled once);
+// RunnerAnimationBase<Derived> binds the leaf's harmony at compile time (see below)
+template <uint8_t CHANNELS, uint16_t LEDS, typename BaseLayer = MarkovBaseLayer<CHANNELS, LEDS>>
+class RunnerAnimationCore : public BaseLayer
 {
 public:
-    // Tunable parameters (MAX_LEDS, FRAME_MS, ANGLE_WIDTH, BASE_BRIGHTNESS, MAX_BRIGHTNESS inherited from MarkovBaseLayer)
+    typedef BaseLayer Layer;
+    using typename Layer::Base;
+    using Layer::MAX_LEDS;
+    using Layer::BASE_BRIGHTNESS;
+
+    // Tunable parameters (MAX_LEDS, FRAME_MS, ANGLE_WIDTH, BASE_BRIGHTNESS, MAX_BRIGHTNESS inherited from the base layer)
     static constexpr uint8_t RUNNER_LENGTH = 30;     // LEDs per runner
-    static constexpr float GAUSSIAN_VARIANCE = 2.5f; // Gaussian blend width (~6-8 pixel blob)
+    static constexpr Q16_16 GAUSSIAN_VARIANCE = Q16_16::fromRatio(5, 2); // Gaussian blend width (~6-8 pixel blob)
     static constexpr uint8_t MIN_RUNNERS = 1;        // At brightness=100
     static constexpr uint8_t MAX_RUNNERS = 6;        // At brightness=0
     static constexpr uint8_t MAX_RUNNER_SLOTS = 6;   // Per channel
+    static constexpr uint16_t RUNNER_SPEED = 20;     // Pixels per second
+    static constexpr unsigned long RUNNER_FRAME_MS = Base::FRAME_MS; // Simulation rate (speed does not depend on it)
+    static constexpr uint8_t SUBPIXEL_PHASES = 16;   // Sampled blob positions per pixel
 
-    struct Runner
-    {
-        int16_t headPos; // Head position on strip (-RUNNER_LENGTH to numLeds-1)
-        uint8_t hue;     // FastLED hue (0-255)
-        uint8_t sat;     // Saturation (255 for harmony, 0 for white/black)
-        uint8_t val;     // Value (255 normally, 0 for black)
-        bool active;     // Currently on strip?
-    };
+    // Head position (pos) is Q16.16, as Q8.8 stops at 127 LEDs; velocity is Q8.8 pixels per frame
+    typedef ParticlePool<MAX_RUNNER_SLOTS> RunnerPool;
 
-    RunnerAnimationBase()
+    RunnerAnimationCore()
     {
         reset();
     }
 
-    // Set channel hues (called by manager when animation starts or hue changes)
-    void setChannelHues(int h1, int h2, int h3, int h4) override
+    void begin() override
     {
-        AnimationBase::setChannelHues(h1, h2, h3, h4);
+        reset();
     }
 
-    // Set channel brightnesses (affects runner count)
-    void setChannelBrightnesses(int b1, int b2, int b3, int b4) override
+    void render(CRGB *const channels[CHANNELS]) override
     {
-        AnimationBase::setChannelBrightnesses(b1, b2, b3, b4);
+        for (uint8_t ch = 0; ch < CHANNELS; ch++)
+        {
+            renderRange(channels[ch], ch, 0, MAX_LEDS);
+        }
     }
 
-    void begin() override
+    unsigned long frameIntervalMs() const override
     {
-        reset();
+        return RUNNER_FRAME_MS;
     }
 
-    bool update(unsigned long deltaMs) override
+    // Sliced frames: each slice steps and renders SLICE_LEDS LEDs of one channel
+    bool beginFrame(unsigned long deltaMs) override
     {
-        frameAccumulator += deltaMs;
-
-        if (frameAccumulator >= FRAME_MS)
-        {
-            frameAccumulator -= FRAME_MS;
-            updateBaseLayer();
-            updateRunners();
-            return true; // Update needed
-        }
-
-        return false; // No update needed yet
+        if (!this->advanceFrame(deltaMs))
+            return false;
+        this->beginBaseFrame();
+        return true;
     }
 
-    void render(CRGB *ch1, CRGB *ch2, CRGB *ch3, CRGB *ch4, uint16_t numLeds) override
+    uint16_t frameSlices() const override
     {
-        renderChannel(ch1, numLeds, 0);
-        renderChannel(ch2, numLeds, 1);
-        renderChannel(ch3, numLeds, 2);
-        renderChannel(ch4, numLeds, 3);
+        return Base::FRAME_SLICES;
     }
 
     void reset() override
     {
-        // Precompute Gaussian blend LUT
-        gaussianLUT.compute(GAUSSIAN_VARIANCE);
-
-        // Initialize base layer state
-        for (int ch = 0; ch < 4; ch++)
+        this->resetBaseLayer();
+        for (int ch = 0; ch < CHANNELS; ch++)
         {
-            for (int i = 0; i < MAX_LEDS; i++)
-            {
-                hueOffset[ch][i] = 0;
-                hueDir[ch][i] = 0;
-                baseBrightness[ch][i] = BASE_BRIGHTNESS;
-                brightDir[ch][i] = 0;
-            }
             cachedBrightness[ch] = 100; // Default to full brightness
 
-            // Deactivate all runners
-            for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
-            {
-                runners[ch][r].active = false;
-                runners[ch][r].headPos = -RUNNER_LENGTH;
-            }
+            runners[ch].clear();
+            covered[ch].clear();
             framesSinceSpawn[ch] = 0;
         }
         frameAccumulator = 0;
     }
 
 protected:
+    using typename Layer::Palette;
+    using Layer::baseColorAt;
+    using Layer::palette;
+    using Layer::cachedBrightness;
+    using Layer::frameAccumulator;
+
     // Runner state
-    Runner runners[4][MAX_RUNNER_SLOTS]; // Per channel
-    uint16_t framesSinceSpawn[4];        // Per channel, for spawn probability
+    RunnerPool runners[CHANNELS];           // Per channel
+    OccupancyMap<MAX_LEDS> covered[CHANNELS]; // LEDs under a runner, per channel
+    uint16_t framesSinceSpawn[CHANNELS];    // Per channel, for spawn probability
 
-    // Gaussian blend lookup table
-    GaussianBlendLUT<RUNNER_LENGTH> gaussianLUT;
+    // Gaussian blend factors by [sub-pixel phase][LED from tail] (generated at compile time)
+    static constexpr auto gaussianLUT = makeSubpixelGaussianLut<RUNNER_LENGTH, SUBPIXEL_PHASES>(GAUSSIAN_VARIANCE.toDouble());
 
-private:
-    // Update runners (spawning and movement)
-    void updateRunners()
+    // Per-frame step for RUNNER_SPEED at the current frame interval
+    Q8_8 runnerVelocity() const
     {
-        for (int ch = 0; ch < 4; ch++)
-        {
-            // Move existing runners
-            for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
-            {
-                if (runners[ch][r].active)
-                {
-                    runners[ch][r].headPos++;
+        return Q8_8::fromRatio((int32_t)RUNNER_SPEED * this->frameIntervalMs(), 1000);
+    }
 
-                    // Deactivate if off the end
-                    if (runners[ch][r].headPos >= MAX_LEDS + RUNNER_LENGTH)
-                    {
-                        runners[ch][r].active = false;
-                    }
-                }
-            }
+    // LEDs a runner with its head at head covers: RUNNER_LENGTH up to the head,
+    // plus the LED after it while between pixels
+    void markRunner(int ch, int16_t head)
+    {
+        covered[ch].mark(head - RUNNER_LENGTH + 1, head + 1);
+    }
 
-            // Check if we can spawn
-            bool pixel0Clear = true;
-            for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
-            {
-                if (runners[ch][r].active && runners[ch][r].headPos < RUNNER_LENGTH)
-                {
-                    pixel0Clear = false;
-                    break;
-                }
-            }
+    // Update one channel's runners (spawning and movement)
+    // Returns the slot of the runner spawned this frame (or RunnerPool::NONE);
+    // its color is picked by the harmony layer
+    int8_t updateRunners(int ch)
+    {
+        RunnerPool &pool = runners[ch];
+        int8_t spawned = RunnerPool::NONE;
+
+        // Move existing runners, removing those off the end, and remap what they cover
+        covered[ch].clear();
+        pool.forEach([&](uint8_t r) {
+            pool.pos[r] = pool.pos[r] + Q16_16::fromRaw((int32_t)pool.velocity[r].raw << 8);
+            if (pool.pos[r].toInt() >= MAX_LEDS + RUNNER_LENGTH)
+                pool.release(r);
+            else
+                markRunner(ch, pool.pos[r].toInt());
+        });
 
-            if (pixel0Clear)
-            {
-                framesSinceSpawn[ch]++;
+        // Can spawn when no runner covers pixel 0 (every runner's tail is past it)
+        bool pixel0Clear = !covered[ch].test(0);
 
-                // Calculate max runners based on brightness (inverted: low brightness = more runners)
-                int maxRunners = MAX_RUNNERS - (cachedBrightness[ch] * (MAX_RUNNERS - MIN_RUNNERS)) / 100;
+        if (pixel0Clear)
+        {
+            framesSinceSpawn[ch]++;
 
-                // Count active runners
-                int activeCount = 0;
-                for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
-                {
-                    if (runners[ch][r].active)
-                        activeCount++;
-                }
+            // Calculate max runners based on brightness (inverted: low brightness = more runners)
+            int maxRunners = MAX_RUNNERS - (cachedBrightness[ch] * (MAX_RUNNERS - MIN_RUNNERS)) / 100;
+            if (this->quality >= Layer::QUALITY_FEWER_OVERLAYS)
+                maxRunners = (maxRunners + 1) / 2;
 
-                if (activeCount < maxRunners)
-                {
-                    // Calculate spawn chance
-                    int targetSpawnInterval = (MAX_LEDS + RUNNER_LENGTH) / maxRunners;
-                    int spawnChance = (framesSinceSpawn[ch] * 100) / targetSpawnInterval;
-                    if (spawnChance > 100)
-                        spawnChance = 100;
+            if (pool.count() < maxRunners)
+            {
+                // Calculate spawn chance
+                int targetSpawnInterval = (MAX_LEDS + RUNNER_LENGTH) / maxRunners;
+                int spawnChance = (framesSinceSpawn[ch] * 100) / targetSpawnInterval;
+                if (spawnChance > 100)
+                    spawnChance = 100;
 
-                    if (random(100) < spawnChance)
+                if (random(100) < spawnChance)
+                {
+                    // Spawn a new runner
+                    spawned = pool.allocate();
+                    if (spawned != RunnerPool::NONE)
                     {
-                        // Spawn a new runner
-                        for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
-                        {
-                            if (!runners[ch][r].active)
-                            {
-                                runners[ch][r].headPos = 0;
-                                pickHarmonyColor(ch, runners[ch][r].hue, runners[ch][r].sat, runners[ch][r].val);
-                                runners[ch][r].active = true;
-                                framesSinceSpawn[ch] = 0;
-                                break;
-                            }
-                        }
+                        pool.pos[spawned] = Q16_16::fromInt(0);
+                        pool.velocity[spawned] = runnerVelocity();
+                        markRunner(ch, 0);
+                        framesSinceSpawn[ch] = 0;
                     }
                 }
             }
-            else
-            {
-                // Can't spawn, don't increment counter
-                framesSinceSpawn[ch] = 0;
-            }
         }
+        else
+        {
+            // Can't spawn, don't increment counter
+            framesSinceSpawn[ch] = 0;
+        }
+        return spawned;
     }
 
-    // Render a single channel
-    void renderChannel(CRGB *leds, uint16_t numLeds, uint8_t channelIndex)
+    // Render LEDs [from, to) of a single channel
+    void renderRange(CRGB *leds, uint8_t channelIndex, uint16_t from, uint16_t to)
     {
-        for (int i = 0; i < numLeds; i++)
+        for (int i = from; i < to; i++)
         {
-            // Compute base color
-            int hue360 = (channelHue[channelIndex] + hueOffset[channelIndex][i] + 360) % 360;
-            uint8_t hue8 = map(hue360, 0, 360, 0, 255);
-            CRGB baseColor = CHSV(hue8, 255, baseBrightness[channelIndex][i]);
+            // Base color: palette lookup scaled by the undulating brightness
+            CRGB baseColor = baseColorAt(channelIndex, i);
 
             // Check if any runner covers this LED
             CRGB finalColor = baseColor;
-            bool inRunner = false;
 
-            for (int r = 0; r < MAX_RUNNER_SLOTS; r++)
+            if (covered[channelIndex].test(i))
             {
-                if (!runners[channelIndex][r].active)
-                    continue;
-
-                int16_t headPos = runners[channelIndex][r].headPos;
-                int16_t tailPos = headPos - RUNNER_LENGTH + 1;
-
-                if (i >= tailPos && i <= headPos)
+                // First runner whose blob covers the LED (head and the LED after it while between pixels)
+                const RunnerPool &pool = runners[channelIndex];
+                int8_t r = pool.find([&](uint8_t slot) {
+                    int16_t headPos = pool.pos[slot].toInt();
+                    return i >= headPos - RUNNER_LENGTH + 1 && i <= headPos + 1;
+                });
+                if (r != RunnerPool::NONE)
                 {
-                    // This LED is in this runner
-                    CRGB runnerColor = CHSV(
-                        runners[channelIndex][r].hue,
-                        runners[channelIndex][r].sat,
-                        runners[channelIndex][r].val);
-
-                    // Calculate blend amount using Gaussian LUT
-                    int posInRunner = i - tailPos;
-                    uint8_t blendFactor = gaussianLUT.table[posInRunner];
-                    finalColor = blend(baseColor, runnerColor, blendFactor);
+                    const CRGB &runnerColor = palette[channelIndex].entry(pool.color[r]);
 
-                    inRunner = true;
-                    break; // Only apply first runner found
+                    // Calculate blend amount using the Gaussian LUT at the head's sub-pixel phase
+                    Q16_16 head = pool.pos[r];
+                    int posInRunner = i - (head.toInt() - RUNNER_LENGTH + 1);
+                    uint8_t phase = head.frac8() / (256 / SUBPIXEL_PHASES);
+                    uint8_t blendFactor = gaussianLUT[phase][posInRunner];
+                    finalColor = blend(baseColor, runnerColor, blendFactor);
                 }
             }
 
@@ -240,3 +223,69 @@ private:
         }
     }
 };
+
+// Harmony layer: a leaf passes itself as Derived (CRTP) and provides getName() and
+// a public static constexpr int HARMONY_OFFSETS[] (hue offsets from primary).
+// Only palette building and the spawn color pick depend on the harmony.
+// A leaf may also pass its base layer engine: MarkovBaseLayer (the default) with a
+// decimation of 2, 4 or 8, or the stateless NoiseBaseLayer (see BaseLayerCore).
+template <typename Derived, uint8_t CHANNELS, uint16_t LEDS, typename BaseLayer = MarkovBaseLayer<CHANNELS, LEDS>>
+class RunnerAnimationBase : public RunnerAnimationCore<CHANNELS, LEDS, BaseLayer>
+{
+public:
+    typedef RunnerAnimationCore<CHANNELS, LEDS, BaseLayer> Core;
+    using typename Core::RunnerPool;
+
+    RunnerAnimationBase()
+    {
+        rebuildPalettes();
+    }
+
+    // Rebuild palettes for the new hues (LED state is palette-relative)
+    void setChannelHues(const int hues[CHANNELS]) override
+    {
+        Core::setChannelHues(hues);
+        rebuildPalettes();
+    }
+
+    bool update(unsigned long deltaMs) override
+    {
+        if (!this->advanceFrame(deltaMs))
+            return false; // No update needed yet
+
+        this->beginBaseFrame();
+        if (this->baseStepDue)
+            this->updateBaseLayer();
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            updateOverlay(ch);
+        }
+        return true; // Update needed
+    }
+
+    void computeSlice(uint16_t slice, CRGB *const channels[CHANNELS]) override
+    {
+        typename Core::SliceRange range = Core::sliceRange(slice);
+        if (this->baseStepDue)
+            this->updateBaseRange(range.channel, range.from, range.to);
+        if (range.from == 0)
+            updateOverlay(range.channel); // Runners move with the channel's first slice
+        this->renderRange(channels[range.channel], range.channel, range.from, range.to);
+    }
+
+private:
+    void updateOverlay(int ch)
+    {
+        int8_t spawned = this->updateRunners(ch);
+        if (spawned != RunnerPool::NONE)
+            this->runners[ch].color[spawned] = this->pickHarmonyColor(Derived::HARMONY_OFFSETS);
+    }
+
+    void rebuildPalettes()
+    {
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            this->palette[ch].build(this->channelHue[ch], Derived::HARMONY_OFFSETS, Core::PRIMARY_HUE_SAT);
+        }
+    }
+};
@@ -3,19 +3,13 @@
 #include "runner_base.h"
 
 // Split-complementary runner animation: primary + two colors adjacent to complement
-class SplitComplementaryRunner : public RunnerAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SplitComplementaryRunner : public RunnerAnimationBase<SplitComplementaryRunner<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Split-Complementary Runner";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 150, 210};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 150, 210};
 };
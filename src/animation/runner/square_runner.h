@@ -3,19 +3,13 @@
 #include "runner_base.h"
 
 // Square runner animation: four colors evenly spaced around the color wheel (90°)
-class SquareRunner : public RunnerAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SquareRunner : public RunnerAnimationBase<SquareRunner<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Square Runner";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 90, 180, 270};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 4;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 90, 180, 270};
 };
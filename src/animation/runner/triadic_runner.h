@@ -3,19 +3,13 @@
 #include "runner_base.h"
 
 // Triadic runner animation: three colors evenly spaced around the color wheel (120°)
-class TriadicRunner : public RunnerAnimationBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class TriadicRunner : public RunnerAnimationBase<TriadicRunner<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Triadic Runner";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 120, 240};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 120, 240};
 };
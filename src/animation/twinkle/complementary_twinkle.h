@@ -5,19 +5,13 @@
 // Complementary Twinkle Animation
 // 2-color harmony: Primary + Opposite (180° apart)
 // Example: Red (0°) + Cyan (180°)
-class ComplementaryTwinkle : public HarmonyTwinkleBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class ComplementaryTwinkle : public HarmonyTwinkleBase<ComplementaryTwinkle<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Complementary Twinkle";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 180};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 2;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 180};
 };
@@ -1,184 +1,242 @@
 #pragma once
 
 #include "../animation_base.h"
+#include "../harmony_palette.h"
+#include "../../lookup_table.h"
+#include "../../fixed_point.h"
+#include "twinkle_field.h"
 
 // Base class for all harmony-based twinkle animations
 // Shares LED strip among harmony colors using brightness-based distribution
 // Primary hue gets 20-80% of LEDs based on brightness (80% at full bright)
 // Each hue includes analogous spread (±5° normal distribution)
+// LEDs store a palette index (hue + spread) and render as a palette lookup
+// Hue groups come from a persistent random LED order: brightness changes move
+// only the LEDs crossing the primary/secondary boundary, hue changes only
+// rebuild the palette, so the scene never reshuffles
 //
-// Derived classes implement getHarmonyOffsets() and getNumHarmonyHues()
-class HarmonyTwinkleBase : public AnimationBase {
+// HarmonyTwinkleCore holds the harmony-independent state and kernels (compiled once);
+// HarmonyTwinkleBase<Derived> binds the leaf's harmony at compile time (see below)
+template <uint8_t CHANNELS, uint16_t LEDS>
+class HarmonyTwinkleCore : public AnimationBase<CHANNELS, LEDS> {
 public:
-    // Tunable parameters (FRAME_MS, ANGLE_WIDTH, MAX_LEDS inherited from AnimationBase)
-    static constexpr uint8_t TWINKLE_DENSITY = 16;   // 1/density chance per frame per LED (higher = fewer twinkles, gentler)
-    static constexpr uint8_t FADE_SPEED = 8;         // How fast LEDs fade to target (0-255, higher = faster, slower)
+    typedef AnimationBase<CHANNELS, LEDS> Base;
+    using Base::MAX_LEDS;
+
+    // Tunable parameters (ANGLE_WIDTH, MAX_LEDS inherited from AnimationBase)
+    // Twinkles are slow, so they are set per second: the frame interval follows
+    // from the largest brightness step a frame may take, and the per-frame
+    // constants from the interval
+    static constexpr uint16_t FADE_PER_SECOND = 160;   // Brightness units per second toward the target
+    static constexpr uint16_t TWINKLE_PERIOD_MS = 800; // Mean time between twinkles of one LED (higher = gentler)
+    static constexpr uint8_t MAX_LED_STEP = 16;        // Largest per-LED change per frame
+    static constexpr unsigned long TWINKLE_FRAME_MS = Base::intervalForStep(MAX_LED_STEP, FADE_PER_SECOND); // 100 ms
+    static constexpr uint8_t TWINKLE_DENSITY = TWINKLE_PERIOD_MS / TWINKLE_FRAME_MS; // 1/density chance per frame per LED
+    static constexpr uint8_t FADE_SPEED = FADE_PER_SECOND * TWINKLE_FRAME_MS / 1000; // Fade step per frame
     static constexpr uint8_t BASE_BRIGHTNESS = 20;   // Minimum brightness when "off"
     static constexpr uint8_t MAX_BRIGHTNESS = 255;   // Maximum brightness when fully lit
 
-    HarmonyTwinkleBase() {
+    HarmonyTwinkleCore() {
         reset();
     }
 
-    // Set channel hues (called by manager when animation starts)
-    void setChannelHues(int h1, int h2, int h3, int h4) override {
-        AnimationBase::setChannelHues(h1, h2, h3, h4);
-
-        // Reassign LED hues with new primary hues
-        for (int ch = 0; ch < 4; ch++) {
-            assignLedHues(ch, cachedBrightness[ch]);
-        }
+    unsigned long frameIntervalMs() const override {
+        return TWINKLE_FRAME_MS;
     }
 
-    // Set channel brightnesses (triggers LED hue reassignment if changed)
-    void setChannelBrightnesses(int b1, int b2, int b3, int b4) override {
-        int brightnesses[4] = {b1, b2, b3, b4};
-        for (int ch = 0; ch < 4; ch++) {
-            if (brightnesses[ch] != cachedBrightness[ch]) {
-                cachedBrightness[ch] = brightnesses[ch];
-                assignLedHues(ch, brightnesses[ch]);
-            }
-        }
-        AnimationBase::setChannelBrightnesses(b1, b2, b3, b4);
+    bool update(unsigned long deltaMs) override {
+        if (!advanceFrame(deltaMs)) return false;  // No update needed yet
+        updateState();
+        return true;  // Update needed
     }
 
-    void begin() override {
-        reset();
-
-        // Assign LED hues now that derived class is fully constructed
-        for (int ch = 0; ch < 4; ch++) {
-            assignLedHues(ch, cachedBrightness[ch]);
+    void render(CRGB* const channels[CHANNELS]) override {
+        // Render each channel with its pre-assigned harmony hues
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            renderRange(channels[ch], ch, 0, MAX_LEDS);
         }
     }
 
-    bool update(unsigned long deltaMs) override {
-        frameAccumulator += deltaMs;
-
-        if (frameAccumulator >= FRAME_MS) {
-            frameAccumulator -= FRAME_MS;
-            updateState();
-            return true;  // Update needed
-        }
+    // Sliced frames: the (sparse) twinkle step runs with slice 0, then each
+    // slice renders SLICE_LEDS LEDs of one channel
+    bool beginFrame(unsigned long deltaMs) override {
+        return advanceFrame(deltaMs);
+    }
 
-        return false;  // No update needed yet
+    uint16_t frameSlices() const override {
+        return Base::FRAME_SLICES;
     }
 
-    void render(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) override {
-        // Render each channel with its pre-assigned harmony hues
-        renderChannel(ch1, numLeds, 0);
-        renderChannel(ch2, numLeds, 1);
-        renderChannel(ch3, numLeds, 2);
-        renderChannel(ch4, numLeds, 3);
+    void computeSlice(uint16_t slice, CRGB* const channels[CHANNELS]) override {
+        if (slice == 0) updateState();
+        typename Base::SliceRange range = Base::sliceRange(slice);
+        renderRange(channels[range.channel], range.channel, range.from, range.to);
     }
 
     void reset() override {
         // Initialize all LEDs to base brightness
-        for (int ch = 0; ch < 4; ch++) {
+        twinkles.reset(BASE_BRIGHTNESS);
+        for (int ch = 0; ch < CHANNELS; ch++) {
             for (int i = 0; i < MAX_LEDS; i++) {
-                currentBrightness[ch][i] = BASE_BRIGHTNESS;
-                targetBrightness[ch][i] = BASE_BRIGHTNESS;
-                ledHue[ch][i] = 0;  // Will be assigned properly in begin()
+                ledColor[ch][i] = 0;  // Will be assigned properly in begin()
+                ledOrder[ch][i] = i;
             }
+            secondaryLeds[ch] = 0;
             cachedBrightness[ch] = 100;  // Default to full brightness
         }
         frameAccumulator = 0;
     }
 
 protected:
-    // Per-LED state (0-255)
-    uint8_t currentBrightness[4][MAX_LEDS];
-    uint8_t targetBrightness[4][MAX_LEDS];
-    uint8_t ledHue[4][MAX_LEDS];  // Pre-assigned hue per LED (FastLED 0-255)
-    uint8_t ledSat[4][MAX_LEDS];  // Pre-assigned saturation per LED (0=white for primary, 255 for secondary)
-
-    // Derived classes implement these to define the harmony
-    virtual const int* getHarmonyOffsets() const = 0;  // Hue offsets from primary (0°, ...)
-    virtual int getNumHarmonyHues() const = 0;         // Number of hues in harmony
-
-    // Assign LED hues based on harmony and brightness-based distribution
-    // Primary hue gets 5-95% of LEDs (95% at brightness=100)
-    // Remaining LEDs divided among secondary hues
-    // LEDs are shuffled to randomize positions
-    void assignLedHues(uint8_t channelIndex, int brightness) {
-        const int* offsets = getHarmonyOffsets();
-        int numHues = getNumHarmonyHues();
-        int primaryHue360 = channelHue[channelIndex];
-
-        // 1. Calculate primary count from brightness (5% at 0, 95% at 100)
-        float primaryPercent = 0.05f + (brightness / 100.0f) * 0.90f;
-        int primaryCount = (int)(MAX_LEDS * primaryPercent);
-
-        // 2. Divide remaining LEDs among secondary hues
-        int remainingLeds = MAX_LEDS - primaryCount;
-        int secondaryCount = (numHues > 1) ? remainingLeds / (numHues - 1) : 0;
-
-        // Handle rounding: give any extra LEDs to primary
-        int totalAssigned = primaryCount + (secondaryCount * (numHues - 1));
-        if (totalAssigned < MAX_LEDS) {
-            primaryCount += (MAX_LEDS - totalAssigned);
+    using Base::ANGLE_WIDTH;
+    using Base::channelHue;
+    using Base::cachedBrightness;
+    using Base::frameAccumulator;
+    using Base::advanceFrame;
+
+    // Per-LED state, brightness for all channels back to back (LED = ch * MAX_LEDS + i)
+    TwinkleField<CHANNELS * MAX_LEDS, TWINKLE_DENSITY, FADE_SPEED> twinkles;
+    uint8_t ledColor[CHANNELS][MAX_LEDS];  // Pre-assigned palette index per LED (harmony hue + spread)
+
+    // Hue group assignment: a shuffled LED order; the last secondaryLeds entries
+    // hold the secondary hues (round-robin from the end), the rest are primary
+    uint16_t ledOrder[CHANNELS][MAX_LEDS];
+    uint16_t secondaryLeds[CHANNELS];
+
+    // Primary hue LED count by brightness (0-100): 5% + brightness * 90%
+    static constexpr Lut<uint16_t, 101> primaryCountLUT = makeLut<uint16_t, 101>([](size_t brightness) {
+        return (uint16_t)((MAX_LEDS * (500 + 90 * brightness)) / 10000);
+    });
+
+    // Per-channel color palettes
+    typedef HarmonyPalette<ANGLE_WIDTH> Palette;
+    Palette palette[CHANNELS];
+
+private:
+    // Update brightness state for all channels (sparse: only twinkling/fading LEDs)
+    void updateState() {
+        twinkles.update([this](uint16_t) {
+            // Pick a random brightness with a cubic distribution (r^3 table, Q0.8)
+            Q0_8 r3 = Q0_8::fromRaw(CUBIC_BIAS8[random(256)]);
+            return (uint8_t)(BASE_BRIGHTNESS + r3.scale(MAX_BRIGHTNESS - BASE_BRIGHTNESS));
+        });
+    }
+
+    // Render LEDs [from, to) of a single channel using pre-assigned palette colors
+    void renderRange(CRGB* leds, uint8_t channelIndex, uint16_t from, uint16_t to) {
+        const Palette& pal = palette[channelIndex];
+        for (int i = from; i < to; i++) {
+            // Palette color scaled to variable brightness
+            leds[i] = pal.color(ledColor[channelIndex][i], twinkles.brightness(channelIndex * MAX_LEDS + i));
         }
+    }
+};
 
-        // 3. Assign LEDs sequentially by hue group
-        int ledIndex = 0;
-        for (int h = 0; h < numHues && ledIndex < MAX_LEDS; h++) {
-            int count = (h == 0) ? primaryCount : secondaryCount;
-            int hue360 = (primaryHue360 + offsets[h] + 360) % 360;
-            uint8_t saturation = (offsets[h] == 0) ? PRIMARY_HUE_SAT : 255;  // Desaturate primary hue
-
-            for (int i = 0; i < count && ledIndex < MAX_LEDS; i++) {
-                int spread = generateSpread();
-                int finalHue360 = (hue360 + spread + 360) % 360;
-                ledHue[channelIndex][ledIndex] = map(finalHue360, 0, 360, 0, 255);
-                ledSat[channelIndex][ledIndex] = saturation;
-                ledIndex++;
+// Harmony layer: a leaf passes itself as Derived (CRTP) and provides getName() and
+// a public static constexpr int HARMONY_OFFSETS[] (hue offsets from primary).
+// Only palette building and hue assignment depend on the harmony.
+template <typename Derived, uint8_t CHANNELS, uint16_t LEDS>
+class HarmonyTwinkleBase : public HarmonyTwinkleCore<CHANNELS, LEDS> {
+public:
+    typedef HarmonyTwinkleCore<CHANNELS, LEDS> Core;
+    using Core::MAX_LEDS;
+
+    HarmonyTwinkleBase() {
+        rebuildPalettes();
+    }
+
+    // Set channel hues (called by manager when animation starts or hue changes)
+    // LED assignments are palette-relative, so only the palettes are rebuilt
+    void setChannelHues(const int hues[CHANNELS]) override {
+        Core::setChannelHues(hues);
+        rebuildPalettes();
+    }
+
+    // Set channel brightnesses (moves LEDs between hue groups if changed)
+    void setChannelBrightnesses(const int brightnesses[CHANNELS]) override {
+        for (int ch = 0; ch < CHANNELS; ch++) {
+            if (brightnesses[ch] != cachedBrightness[ch]) {
+                cachedBrightness[ch] = brightnesses[ch];
+                assignLedHues(ch, brightnesses[ch]);
             }
         }
+    }
+
+    void begin() override {
+        this->reset();
+
+        // Shuffle LED order and assign hues now that derived class is fully constructed
+        for (int ch = 0; ch < CHANNELS; ch++) {
+            shuffleLeds(ch);
+            assignLedHues(ch, cachedBrightness[ch]);
+        }
+    }
 
-        // 4. Fisher-Yates shuffle to randomize LED positions
+protected:
+    using typename Core::Palette;
+    using Core::channelHue;
+    using Core::cachedBrightness;
+    using Core::ledColor;
+    using Core::ledOrder;
+    using Core::secondaryLeds;
+    using Core::palette;
+    using Core::primaryCountLUT;
+    using Core::generateSpread;
+
+    static constexpr int NUM_HUES = sizeof(Derived::HARMONY_OFFSETS) / sizeof(Derived::HARMONY_OFFSETS[0]);
+    static constexpr int SECONDARY_HUES = (NUM_HUES > 1) ? NUM_HUES - 1 : 1;
+
+    // New random LED order for a channel, all LEDs primary with fresh spread
+    void shuffleLeds(uint8_t channelIndex) {
+        uint16_t* order = ledOrder[channelIndex];
+
+        // Fisher-Yates shuffle to randomize LED positions
         for (int i = MAX_LEDS - 1; i > 0; i--) {
             int j = random(0, i + 1);
-            uint8_t temp = ledHue[channelIndex][i];
-            ledHue[channelIndex][i] = ledHue[channelIndex][j];
-            ledHue[channelIndex][j] = temp;
+            uint16_t temp = order[i];
+            order[i] = order[j];
+            order[j] = temp;
+        }
+        for (int i = 0; i < MAX_LEDS; i++) {
+            ledColor[channelIndex][i] = Palette::harmonyIndex(0, generateSpread());
         }
+        secondaryLeds[channelIndex] = 0;
     }
 
-private:
-    // Update brightness state for all channels
-    void updateState() {
-        for (int ch = 0; ch < 4; ch++) {
-            for (int i = 0; i < MAX_LEDS; i++) {
-                // Random chance to assign new target brightness
-                if (random(TWINKLE_DENSITY) == 0) {
-                    // Pick a random brightness biased towards brighter values
-                    // Use cubic distribution: r^3 biases towards 1.0 (brighter)
-                    float r = random(1000) / 1000.0f;  // 0.0 to 1.0
-                    r = r * r * r;  // Cubic bias towards 1.0
-                    uint8_t range = MAX_BRIGHTNESS - BASE_BRIGHTNESS;
-                    targetBrightness[ch][i] = BASE_BRIGHTNESS + (uint8_t)(r * range);
-                }
-
-                // Fade current brightness toward target
-                if (currentBrightness[ch][i] < targetBrightness[ch][i]) {
-                    currentBrightness[ch][i] = qadd8(currentBrightness[ch][i], FADE_SPEED);
-                    if (currentBrightness[ch][i] > targetBrightness[ch][i]) {
-                        currentBrightness[ch][i] = targetBrightness[ch][i];
-                    }
-                } else if (currentBrightness[ch][i] > targetBrightness[ch][i]) {
-                    currentBrightness[ch][i] = qsub8(currentBrightness[ch][i], FADE_SPEED);
-                    if (currentBrightness[ch][i] < targetBrightness[ch][i]) {
-                        currentBrightness[ch][i] = targetBrightness[ch][i];
-                    }
-                }
-            }
+    // Move LEDs between hue groups to match a brightness (0-100)
+    // Primary hue gets 5-95% of LEDs (95% at brightness=100), the rest is divided
+    // evenly among secondary hues (rounding extra goes to primary). Only LEDs
+    // crossing the boundary change hue; they keep their spread.
+    void assignLedHues(uint8_t channelIndex, int brightness) {
+        // Secondary LED total from brightness (primary count from the LUT)
+        uint16_t target = 0;
+        if (NUM_HUES > 1) {
+            int primaryCount = primaryCountLUT[constrain(brightness, 0, 100)];
+            target = ((MAX_LEDS - primaryCount) / SECONDARY_HUES) * SECONDARY_HUES;
+        }
+
+        const uint16_t* order = ledOrder[channelIndex];
+        uint8_t* colors = ledColor[channelIndex];
+        uint16_t& count = secondaryLeds[channelIndex];
+
+        // Grow: rank count (from the end) takes secondary hue 1 + count % SECONDARY_HUES
+        while (count < target) {
+            uint16_t led = order[MAX_LEDS - 1 - count];
+            colors[led] = Palette::withHarmony(colors[led], 1 + count % SECONDARY_HUES);
+            count++;
+        }
+        // Shrink: hand the most recent secondary LEDs back to primary
+        while (count > target) {
+            count--;
+            uint16_t led = order[MAX_LEDS - 1 - count];
+            colors[led] = Palette::withHarmony(colors[led], 0);
         }
     }
 
-    // Render twinkle effect for a single channel using pre-assigned hues and saturations
-    void renderChannel(CRGB* leds, uint16_t numLeds, uint8_t channelIndex) {
-        for (int i = 0; i < numLeds; i++) {
-            // Use pre-assigned hue and saturation with variable brightness
-            leds[i] = CHSV(ledHue[channelIndex][i], ledSat[channelIndex][i], currentBrightness[channelIndex][i]);
+private:
+    void rebuildPalettes() {
+        for (int ch = 0; ch < CHANNELS; ch++) {
+            palette[ch].build(channelHue[ch], Derived::HARMONY_OFFSETS, Core::PRIMARY_HUE_SAT);
         }
     }
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../animation_base.h"
+#include "../../lookup_table.h"
+#include "twinkle_field.h"
 
 // Monochromatic Twinkle Effect Animation
 // Random LEDs fade in and out at different rates, creating a sparkling effect
@@ -12,8 +14,14 @@
 //    - Some LEDs get new random target brightness (twinkle density)
 //    - All LEDs fade toward their target brightness (fade speed)
 // 3. Color based on channel's stored hue (from HomeKit state) with analogous spread
-class MonochromaticTwinkle : public AnimationBase {
+//    Each LED's spread is stored and re-rolled only when it picks a new target,
+//    so rendering does no RNG work and the hue holds steady through a fade
+template <uint8_t CHANNELS, uint16_t LEDS>
+class MonochromaticTwinkle : public AnimationBase<CHANNELS, LEDS> {
 public:
+    typedef AnimationBase<CHANNELS, LEDS> Base;
+    using Base::MAX_LEDS;
+
     // Tunable parameters (FRAME_MS, ANGLE_WIDTH, MAX_LEDS inherited from AnimationBase)
     static constexpr uint8_t TWINKLE_DENSITY = 8;    // 1/density chance per frame per LED (higher = fewer twinkles)
     static constexpr uint8_t FADE_SPEED = 15;        // How fast LEDs fade to target (0-255, higher = faster)
@@ -24,42 +32,44 @@ public:
         reset();
     }
 
-    // Set channel hues (called by manager when animation starts)
-    void setChannelHues(int h1, int h2, int h3, int h4) override {
-        AnimationBase::setChannelHues(h1, h2, h3, h4);
-    }
-
     void begin() override {
         reset();
     }
 
     bool update(unsigned long deltaMs) override {
-        frameAccumulator += deltaMs;
+        if (!advanceFrame(deltaMs)) return false;  // No update needed yet
+        updateState();
+        return true;  // Update needed
+    }
 
-        if (frameAccumulator >= FRAME_MS) {
-            frameAccumulator -= FRAME_MS;
-            updateState();
-            return true;  // Update needed
+    void render(CRGB* const channels[CHANNELS]) override {
+        // Render each channel with its stored hue
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            renderRange(channels[ch], ch, 0, MAX_LEDS);
         }
+    }
 
-        return false;  // No update needed yet
+    // Sliced frames: the (sparse) twinkle step runs with slice 0, then each
+    // slice renders SLICE_LEDS LEDs of one channel
+    bool beginFrame(unsigned long deltaMs) override {
+        return advanceFrame(deltaMs);
     }
 
-    void render(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) override {
-        // Render each channel with its stored hue
-        renderChannel(ch1, numLeds, 0);
-        renderChannel(ch2, numLeds, 1);
-        renderChannel(ch3, numLeds, 2);
-        renderChannel(ch4, numLeds, 3);
+    uint16_t frameSlices() const override {
+        return Base::FRAME_SLICES;
+    }
+
+    void computeSlice(uint16_t slice, CRGB* const channels[CHANNELS]) override {
+        if (slice == 0) updateState();
+        typename Base::SliceRange range = Base::sliceRange(slice);
+        renderRange(channels[range.channel], range.channel, range.from, range.to);
     }
 
     void reset() override {
         // Initialize all LEDs to base brightness
-        for (int ch = 0; ch < 4; ch++) {
-            for (int i = 0; i < MAX_LEDS; i++) {
-                currentBrightness[ch][i] = BASE_BRIGHTNESS;
-                targetBrightness[ch][i] = BASE_BRIGHTNESS;
-            }
+        twinkles.reset(BASE_BRIGHTNESS);
+        for (int i = 0; i < CHANNELS * MAX_LEDS; i++) {
+            ledSpread[i] = generateSpread();
         }
         frameAccumulator = 0;
     }
@@ -68,50 +78,48 @@ public:
         return "Monochromatic Twinkle";
     }
 
-private:
-    // Per-LED brightness state (0-255)
-    uint8_t currentBrightness[4][MAX_LEDS];
-    uint8_t targetBrightness[4][MAX_LEDS];
+    // Quality 1: cheaper hue jitter for new twinkles (the per-event cost)
+    uint8_t qualityLevels() const override { return 2; }
 
-    // Update brightness state for all channels
+    void setQuality(uint8_t level) override {
+        Base::setQuality(level);
+        reducedSpread = quality >= 1;
+    }
+
+private:
+    using Base::FRAME_MS;
+    using Base::channelHue;
+    using Base::frameAccumulator;
+    using Base::advanceFrame;
+    using Base::generateSpread;
+    using Base::quality;
+    using Base::reducedSpread;
+
+    // Per-LED brightness state, all channels back to back (LED = ch * MAX_LEDS + i)
+    TwinkleField<CHANNELS * MAX_LEDS, TWINKLE_DENSITY, FADE_SPEED> twinkles;
+    int8_t ledSpread[CHANNELS * MAX_LEDS];  // Analogous hue jitter (degrees), same indexing
+
+    // Update brightness state for all channels (sparse: only twinkling/fading LEDs)
     void updateState() {
-        for (int ch = 0; ch < 4; ch++) {
-            for (int i = 0; i < MAX_LEDS; i++) {
-                // Random chance to assign new target brightness
-                if (random(TWINKLE_DENSITY) == 0) {
-                    // Pick a random brightness between BASE and MAX
-                    targetBrightness[ch][i] = random(BASE_BRIGHTNESS, MAX_BRIGHTNESS);
-                }
-
-                // Fade current brightness toward target
-                if (currentBrightness[ch][i] < targetBrightness[ch][i]) {
-                    currentBrightness[ch][i] = qadd8(currentBrightness[ch][i], FADE_SPEED);
-                    if (currentBrightness[ch][i] > targetBrightness[ch][i]) {
-                        currentBrightness[ch][i] = targetBrightness[ch][i];
-                    }
-                } else if (currentBrightness[ch][i] > targetBrightness[ch][i]) {
-                    currentBrightness[ch][i] = qsub8(currentBrightness[ch][i], FADE_SPEED);
-                    if (currentBrightness[ch][i] < targetBrightness[ch][i]) {
-                        currentBrightness[ch][i] = targetBrightness[ch][i];
-                    }
-                }
-            }
-        }
+        twinkles.update([this](uint16_t index) {
+            // New twinkle: fresh hue jitter and a random brightness between BASE and MAX
+            ledSpread[index] = generateSpread();
+            return (uint8_t)random(BASE_BRIGHTNESS, MAX_BRIGHTNESS);
+        });
     }
 
-    // Render twinkle effect for a single channel
-    void renderChannel(CRGB* leds, uint16_t numLeds, uint8_t channelIndex) {
+    // Render LEDs [from, to) of a single channel
+    void renderRange(CRGB* leds, uint8_t channelIndex, uint16_t from, uint16_t to) {
         // Convert HomeKit hue (0-360) to base hue
         int baseHue360 = channelHue[channelIndex];
+        uint16_t first = channelIndex * MAX_LEDS;
 
-        for (int i = 0; i < numLeds; i++) {
-            // Apply analogous spread to each LED
-            int spread = generateSpread();
-            int finalHue360 = (baseHue360 + spread + 360) % 360;
-            uint8_t hue8 = map(finalHue360, 0, 360, 0, 255);
+        for (int i = from; i < to; i++) {
+            // Apply the LED's stored analogous spread
+            uint8_t hue8 = hue8FromDegrees(baseHue360 + ledSpread[first + i]);
 
             // Use channel's hue with spread, full saturation, variable brightness
-            leds[i] = CHSV(hue8, 255, currentBrightness[channelIndex][i]);
+            leds[i] = CHSV(hue8, 255, twinkles.brightness(first + i));
         }
     }
 };
@@ -5,19 +5,13 @@
 // Split-Complementary Twinkle Animation
 // 3-color harmony: Primary + Two adjacent to complement
 // Example: Red (0°) + Yellow-Green (150°) + Blue-Violet (210°)
-class SplitComplementaryTwinkle : public HarmonyTwinkleBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SplitComplementaryTwinkle : public HarmonyTwinkleBase<SplitComplementaryTwinkle<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Split-Complementary Twinkle";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 150, 210};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 150, 210};
 };
@@ -5,19 +5,13 @@
 // Square Twinkle Animation
 // 4-color harmony: Square on color wheel (90° apart)
 // Example: Red (0°) + Yellow (90°) + Cyan (180°) + Magenta (270°)
-class SquareTwinkle : public HarmonyTwinkleBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SquareTwinkle : public HarmonyTwinkleBase<SquareTwinkle<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Square Twinkle";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 90, 180, 270};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 4;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 90, 180, 270};
 };
@@ -5,19 +5,13 @@
 // Triadic Twinkle Animation
 // 3-color harmony: Evenly spaced (120° apart)
 // Example: Red (0°) + Green (120°) + Blue (240°)
-class TriadicTwinkle : public HarmonyTwinkleBase {
+template <uint8_t CHANNELS, uint16_t LEDS>
+class TriadicTwinkle : public HarmonyTwinkleBase<TriadicTwinkle<CHANNELS, LEDS>, CHANNELS, LEDS> {
 public:
     const char* getName() const override {
         return "Triadic Twinkle";
     }
 
-protected:
-    const int* getHarmonyOffsets() const override {
-        static const int offsets[] = {0, 120, 240};
-        return offsets;
-    }
-
-    int getNumHarmonyHues() const override {
-        return 3;
-    }
+    // Hue offsets from primary, resolved at compile time by the base class
+    static constexpr int HARMONY_OFFSETS[] = {0, 120, 240};
 };
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "../../lookup_table.h"
+
+// Sparse, event-driven twinkle state
+//
+// Each LED independently picks a new target brightness with probability
+// 1/DENSITY per frame, then fades toward it by FADE_SPEED per frame.
+// Instead of rolling the dice for every LED every frame, the gaps between
+// events are drawn from the matching geometric distribution (one RNG draw
+// per event), and only LEDs that are still fading are visited - they are
+// tracked in an active bitmask. Per-frame cost scales with the number of
+// changing LEDs rather than NUM_LEDS.
+//
+// The event sequence runs across frame boundaries (LED index wraps into the
+// next frame), which is exactly equivalent to an independent Bernoulli trial
+// per LED per frame.
+template <uint16_t NUM_LEDS, uint8_t DENSITY, uint8_t FADE_SPEED>
+class TwinkleField {
+public:
+    // Gap CDF covers this many LEDs; longer gaps draw again (memoryless)
+    static constexpr uint8_t GAP_TABLE_SIZE = 64;
+
+    void reset(uint8_t level) {
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            current[i] = level;
+            target[i] = level;
+        }
+        for (uint16_t w = 0; w < MASK_WORDS; w++) {
+            active[w] = 0;
+        }
+        nextEvent = sampleGap();
+    }
+
+    // Advance one frame
+    // newTarget(index) is called for each LED that twinkles and returns its new target
+    template <typename NewTarget>
+    void update(NewTarget newTarget) {
+        // Twinkle events: jump from event to event
+        uint32_t pos = nextEvent;
+        while (pos < NUM_LEDS) {
+            target[pos] = newTarget((uint16_t)pos);
+            if (target[pos] != current[pos]) {
+                active[pos / 32] |= (1UL << (pos % 32));
+            }
+            pos += 1 + sampleGap();
+        }
+        nextEvent = pos - NUM_LEDS;
+
+        // Fade LEDs that have not reached their target yet
+        for (uint16_t w = 0; w < MASK_WORDS; w++) {
+            uint32_t bits = active[w];
+            while (bits) {
+                uint8_t bit = __builtin_ctz(bits);
+                bits &= bits - 1;
+                uint16_t i = w * 32 + bit;
+
+                if (current[i] < target[i]) {
+                    current[i] = qadd8(current[i], FADE_SPEED);
+                    if (current[i] > target[i]) current[i] = target[i];
+                } else {
+                    current[i] = qsub8(current[i], FADE_SPEED);
+                    if (current[i] < target[i]) current[i] = target[i];
+                }
+                if (current[i] == target[i]) {
+                    active[w] &= ~(1UL << bit);
+                }
+            }
+        }
+    }
+
+    uint8_t brightness(uint16_t index) const { return current[index]; }
+
+    // Number of LEDs still fading toward their target
+    uint16_t activeCount() const {
+        uint16_t count = 0;
+        for (uint16_t w = 0; w < MASK_WORDS; w++) {
+            count += __builtin_popcount(active[w]);
+        }
+        return count;
+    }
+
+    // Number of non-events before the next event: Geometric(1/DENSITY)
+    static uint32_t sampleGap() {
+        uint32_t gap = 0;
+        for (;;) {
+            uint16_t u = (uint16_t)random(65536);
+            if (u < gapCdf[GAP_TABLE_SIZE - 1]) {
+                // Binary search: first k with u < cdf[k]
+                uint8_t lo = 0;
+                uint8_t hi = GAP_TABLE_SIZE - 1;
+                while (lo < hi) {
+                    uint8_t mid = (lo + hi) / 2;
+                    if (u < gapCdf[mid]) hi = mid; else lo = mid + 1;
+                }
+                return gap + lo;
+            }
+            gap += GAP_TABLE_SIZE;  // Past the table: memoryless, so draw again
+        }
+    }
+
+private:
+    static constexpr uint16_t MASK_WORDS = (NUM_LEDS + 31) / 32;
+
+    // P(gap <= k) = 1 - (1 - 1/DENSITY)^(k+1), scaled to 0-65536
+    static constexpr Lut<uint16_t, GAP_TABLE_SIZE> gapCdf = makeLut<uint16_t, GAP_TABLE_SIZE>([](size_t k) {
+        double cdf = 1.0 - lutmath::pow(1.0 - 1.0 / DENSITY, k + 1.0);
+        double scaled = cdf * 65536.0 + 0.5;
+        return (uint16_t)(scaled >= 65535.0 ? 65535 : scaled);
+    });
+
+    uint8_t current[NUM_LEDS];
+    uint8_t target[NUM_LEDS];
+    uint32_t active[MASK_WORDS];    // Bit set = LED still fading
+    uint32_t nextEvent;             // LED index of the next event in the coming frame
+};
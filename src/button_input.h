@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// A raw GPIO edge captured in the interrupt handler
+struct ButtonEdge {
+    unsigned long timestampMs;
+    bool pressed;               // Level after the edge (true = LOW = pressed)
+};
+
+// Single-producer/single-consumer ring buffer of edges
+// Producer: GPIO ISR (push). Consumer: loop() (pop). No locks - each side
+// only writes its own index, published with release/acquire ordering.
+// CAPACITY must be a power of two; one slot is kept free to tell full from empty.
+template <uint8_t CAPACITY>
+class EdgeQueue {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "EdgeQueue capacity must be a power of two");
+
+public:
+    EdgeQueue() : head(0), tail(0), dropped(0) {}
+
+    // Producer side (ISR-safe)
+    bool IRAM_ATTR push(const ButtonEdge& edge) {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        uint8_t next = (h + 1) & (CAPACITY - 1);
+        if (next == tail.load(std::memory_order_acquire)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;  // Full - edge lost
+        }
+        edges[h] = edge;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(ButtonEdge& edge) {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;  // Empty
+        }
+        edge = edges[t];
+        tail.store((t + 1) & (CAPACITY - 1), std::memory_order_release);
+        return true;
+    }
+
+    uint8_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    ButtonEdge edges[CAPACITY];
+    std::atomic<uint8_t> head;      // Next slot to write (producer)
+    std::atomic<uint8_t> tail;      // Next slot to read (consumer)
+    std::atomic<uint8_t> dropped;   // Edges lost to a full queue
+};
+
+// Debounced button events
+enum ButtonEventType {
+    BUTTON_PRESSED,
+    BUTTON_RELEASED
+};
+
+struct ButtonEvent {
+    ButtonEventType type;
+    unsigned long timestampMs;  // When the (debounced) edge happened
+    unsigned long heldMs;       // Press duration (BUTTON_RELEASED only)
+};
+
+// Interrupt-driven button input (active LOW)
+// The ISR timestamps every edge into an EdgeQueue; poll() debounces from those
+// timestamps, so edges are never missed when loop() is slow and nothing is
+// read from the pin between interrupts.
+//
+// Debounce: an edge changing the stable state is accepted if it comes at least
+// debounceMs after the previously accepted one. Edges inside that window are
+// remembered as the raw level; if the raw level still differs from the stable
+// state once the window closes, the change is accepted at that point. Edges
+// that do not change the level (e.g. GPIO36/39 interrupt glitches) are ignored.
+class ButtonInput {
+public:
+    static constexpr uint8_t QUEUE_SIZE = 16;
+
+    ButtonInput(uint8_t gpioPin, unsigned long debounce) :
+        pin(gpioPin), debounceMs(debounce),
+        stablePressed(false), rawPressed(false),
+        lastAcceptedMs(0), rawEdgeMs(0), pressStartMs(0) {}
+
+#ifndef NATIVE_TEST
+    // Configure the pin and attach the edge interrupt
+    void begin() {
+        pinMode(pin, INPUT_PULLUP);
+        stablePressed = rawPressed = (digitalRead(pin) == LOW);
+        attachInterruptArg(digitalPinToInterrupt(pin), onEdgeISR, this, CHANGE);
+    }
+#endif
+
+    // Record an edge (called from the ISR; host tests inject edge sequences here)
+    void IRAM_ATTR recordEdge(unsigned long timestampMs, bool pressed) {
+        queue.push({timestampMs, pressed});
+    }
+
+    // Drain captured edges and return the next debounced event, if any
+    // Call repeatedly until it returns false
+    bool poll(unsigned long now, ButtonEvent& event) {
+        ButtonEdge edge;
+        while (queue.pop(edge)) {
+            rawPressed = edge.pressed;
+            rawEdgeMs = edge.timestampMs;
+            if (rawPressed != stablePressed && edge.timestampMs - lastAcceptedMs >= debounceMs) {
+                return accept(edge.timestampMs, event);
+            }
+        }
+
+        // Bounce window closed with the level still changed: accept it now
+        // (signed compare: ISR timestamps may be newer than the frame clock)
+        if (rawPressed != stablePressed && (long)(now - lastAcceptedMs) >= (long)debounceMs) {
+            unsigned long settledMs = lastAcceptedMs + debounceMs;
+            return accept(rawEdgeMs > settledMs ? rawEdgeMs : settledMs, event);
+        }
+        return false;
+    }
+
+    bool isPressed() const { return stablePressed; }
+
+    // How long the button has been held (0 if released)
+    unsigned long heldFor(unsigned long now) const {
+        if (!stablePressed || (long)(now - pressStartMs) < 0) return 0;
+        return now - pressStartMs;
+    }
+
+    uint8_t droppedEdges() const { return queue.droppedCount(); }
+
+private:
+    uint8_t pin;
+    unsigned long debounceMs;
+    EdgeQueue<QUEUE_SIZE> queue;
+
+    bool stablePressed;             // Debounced state
+    bool rawPressed;                // Level after the latest captured edge
+    unsigned long lastAcceptedMs;   // Timestamp of the last debounced transition
+    unsigned long rawEdgeMs;        // Timestamp of the latest captured edge
+    unsigned long pressStartMs;
+
+    bool accept(unsigned long timestampMs, ButtonEvent& event) {
+        stablePressed = rawPressed;
+        lastAcceptedMs = timestampMs;
+
+        if (stablePressed) {
+            pressStartMs = timestampMs;
+            event = {BUTTON_PRESSED, timestampMs, 0};
+        } else {
+            event = {BUTTON_RELEASED, timestampMs, timestampMs - pressStartMs};
+        }
+        return true;
+    }
+
+#ifndef NATIVE_TEST
+    static void IRAM_ATTR onEdgeISR(void* arg) {
+        ButtonInput* self = static_cast<ButtonInput*>(arg);
+        self->recordEdge(millis(), digitalRead(self->pin) == LOW);
+    }
+#endif
+};
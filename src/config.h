@@ -1,5 +1,8 @@
 #pragma once
 
+#include "led_canvas.h"
+#include "output/output_stage.h"
+
 // GPIO Pin Definitions - M5Stack Stamp Pico
 // Based on docs/HARDWARE.md
 
@@ -7,18 +10,70 @@
 constexpr uint8_t PIN_STATUS_SK6812 = 27;  // SK6812 RGB LED (1 pixel) - Channel 0 status indicator
 constexpr uint8_t PIN_STATUS_LED = 22;     // Single-color LED for status indication
 
-// External LED Strip Channels (WS2811, 200 LEDs each)
-constexpr uint8_t PIN_LED_CH1 = 26;        // LED Strip Channel 1 Data
-constexpr uint8_t PIN_LED_CH2 = 18;        // LED Strip Channel 2 Data
-constexpr uint8_t PIN_LED_CH3 = 19;        // LED Strip Channel 3 Data
-constexpr uint8_t PIN_LED_CH4 = 25;        // LED Strip Channel 4 Data
+// External LED Strip Channels (WS2811, NUM_LEDS_PER_CHANNEL LEDs each)
+// One data pin per channel, in channel order (NUM_CHANNELS entries)
+constexpr uint8_t PIN_LED_CHANNELS[] = {
+    26,                                    // LED Strip Channel 1 Data
+    18,                                    // LED Strip Channel 2 Data
+    19,                                    // LED Strip Channel 3 Data
+    25,                                    // LED Strip Channel 4 Data
+};
 
 // Button Input
 constexpr uint8_t PIN_BUTTON = 39;         // Button input (GPIO39 - input only) - Factory reset
 constexpr uint8_t PIN_BUTTON_ANIM = 0;     // Button input (GPIO0) - Animation cycling
 
 // LED Configuration
-constexpr uint8_t NUM_LEDS_PER_CHANNEL = 200;  // 200 LEDs per channel
+// Channel count and strip length size all animation and LED state at compile time
+// (up to 8 channels; e.g. 8 x 600 with eight entries in PIN_LED_CHANNELS)
+constexpr uint8_t NUM_CHANNELS = 4;
+constexpr uint16_t NUM_LEDS_PER_CHANNEL = 200;  // 200 LEDs per channel
+static_assert(sizeof(PIN_LED_CHANNELS) == NUM_CHANNELS, "One data pin per channel");
+
+// LED Output Backend
+// OUTPUT_FASTLED:      FastLED drivers (default)
+// OUTPUT_PARALLEL_RMT: one RMT transmitter per channel, all started together with
+//                      rmtWriteAsync (frame time = one channel's wire time)
+enum LedOutputBackend { OUTPUT_FASTLED, OUTPUT_PARALLEL_RMT };
+constexpr LedOutputBackend LED_OUTPUT_BACKEND = OUTPUT_FASTLED;
+constexpr uint8_t LED_OUTPUT_BRIGHTNESS = 64;   // Global output brightness (25% for safe testing)
+
+// Output Stage (gamma 2.2, color correction, temporal dithering - see output/output_stage.h)
+constexpr bool OUTPUT_DITHERING = true;
+constexpr bool OUTPUT_INTERPOLATION = true;      // Blend between animation frames at the output rate (output/frame_interpolator.h)
+// Per-channel color correction, in channel order; e.g. ColorMatrix::whiteBalance(1.0, 0.7, 0.9)
+// for a strip that runs green/blue heavy
+constexpr ColorMatrix CHANNEL_COLOR_CORRECTION[] = {
+    ColorMatrix::identity(),                // LED Strip Channel 1
+    ColorMatrix::identity(),                // LED Strip Channel 2
+    ColorMatrix::identity(),                // LED Strip Channel 3
+    ColorMatrix::identity(),                // LED Strip Channel 4
+};
+static_assert(sizeof(CHANNEL_COLOR_CORRECTION) / sizeof(ColorMatrix) == NUM_CHANNELS, "One color correction per channel");
+
+// Power Budget (see docs/HARDWARE.md: ~60 mA per LED at full white)
+// The output brightness is lowered per frame so the estimated strip current stays within budget
+constexpr uint32_t POWER_BUDGET_MA = 40000;     // 80% of a 5V 50A supply
+constexpr uint16_t LED_MA_PER_COLOR = 20;       // Per R/G/B output at full value
+constexpr uint16_t LED_IDLE_UA = 1000;          // Quiescent current per LED (uA)
+
+// Canvas Layout
+// Animations render NUM_SEGMENTS segments of NUM_LEDS_PER_SEGMENT pixels;
+// SEGMENT_LAYOUT places them onto physical channel ranges
+// ({segment, segmentStart, channel, channelStart, count, reversed}).
+// Each segment follows the HomeKit state of the channel showing its first pixel.
+//   One 800-pixel run over all four strips: NUM_SEGMENTS = 1, NUM_LEDS_PER_SEGMENT = 800,
+//     {0, 0, 0, 0, 200, false}, {0, 200, 1, 0, 200, false}, ...
+//   Two 100-pixel zones per strip: NUM_SEGMENTS = 8, NUM_LEDS_PER_SEGMENT = 100,
+//     {0, 0, 0, 0, 100, false}, {1, 0, 0, 100, 100, false}, ...
+constexpr uint8_t NUM_SEGMENTS = NUM_CHANNELS;
+constexpr uint16_t NUM_LEDS_PER_SEGMENT = NUM_LEDS_PER_CHANNEL;
+constexpr SegmentRun SEGMENT_LAYOUT[] = {
+    {0, 0, 0, 0, NUM_LEDS_PER_CHANNEL, false},  // Segment 1 -> Channel 1
+    {1, 0, 1, 0, NUM_LEDS_PER_CHANNEL, false},  // Segment 2 -> Channel 2
+    {2, 0, 2, 0, NUM_LEDS_PER_CHANNEL, false},  // Segment 3 -> Channel 3
+    {3, 0, 3, 0, NUM_LEDS_PER_CHANNEL, false},  // Segment 4 -> Channel 4
+};
 
 // Blink Configuration
 constexpr unsigned long BLINK_INTERVAL_MS = 500;  // 500ms on, 500ms off = 1Hz blink
@@ -33,6 +88,16 @@ constexpr unsigned long FACTORY_RESET_CONFIRM_MS = 3000;   // 3 seconds - green
 // Animation Button Configuration
 constexpr unsigned long ANIM_BUTTON_LONG_PRESS_MS = 2000;  // 2 seconds - long press for reset
 
+// Loop Scheduler Configuration (task periods)
+constexpr unsigned long HOMESPAN_POLL_PERIOD_MS = 10;   // HomeKit/network servicing
+constexpr unsigned long BUTTON_PERIOD_MS = 10;          // Drain button edge queues (edges are timestamped in the ISR)
+constexpr unsigned long RENDER_PERIOD_MS = 10;          // Notification/animation frame updates
+constexpr unsigned long OUTPUT_PERIOD_MS = 20;          // Output stage + show() (50 Hz)
+constexpr unsigned long PERSISTENCE_PERIOD_MS = 2000;   // Coalesced NVS writes of channel state
+constexpr unsigned long SCHEDULER_STATS_PERIOD_MS = 60000; // Idle percentage report
+constexpr uint32_t ANIMATION_SLICE_BUDGET_US = 1000;    // Animation frame work per render run (rest resumes next run)
+constexpr uint32_t ANIMATION_FRAME_BUDGET_US = 20000;   // Frame start to commit; slower frames lower animation quality
+
 // HomeSpan Configuration
 constexpr const char* DEVICE_NAME = "Sputter Lights";
 constexpr const char* DEVICE_MANUFACTURER = "0x76656E Labs";
@@ -41,17 +106,12 @@ constexpr const char* DEVICE_MODEL = "4CH-LED";
 constexpr const char* DEVICE_FIRMWARE = "1.0.0";
 
 // Channel Defaults
-constexpr int NUM_CHANNELS = 4;
 constexpr int DEFAULT_BRIGHTNESS = 80;    // Minimum visible brightness (was MIN_BRIGHTNESS)
 constexpr int DEFAULT_SATURATION = 100;   // Full color saturation
 
-// Default hue per channel (90° spacing around color wheel)
+// Default hue per channel (1-based), evenly spaced around the color wheel
+// 4 channels: 0° red, 90° yellow/orange, 180° cyan, 270° purple/magenta
 inline int getDefaultHue(int channelNum) {
-    switch (channelNum) {
-        case 1: return 0;    // Red
-        case 2: return 90;   // Yellow/Orange
-        case 3: return 180;  // Cyan
-        case 4: return 270;  // Purple/Magenta
-        default: return 0;
-    }
+    if (channelNum < 1 || channelNum > NUM_CHANNELS) return 0;
+    return (channelNum - 1) * 360 / NUM_CHANNELS;
 }
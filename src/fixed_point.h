@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <limits>
+
+// Fixed-point numbers for animation math (no float at runtime)
+//
+// Fixed<STORAGE, WIDE, FRAC_BITS> stores value * 2^FRAC_BITS in STORAGE;
+// WIDE holds intermediate products. Provided formats:
+//
+//   Q0_8   uint8_t   0 .. 0.996         step 1/256 (0.0039)   fractions, blend amounts
+//   Q8_8   int16_t   -128 .. 127.996    step 1/256 (0.0039)   LED positions, velocities
+//   Q16_16 int32_t   -32768 .. 32767.99 step 1/65536 (1.5e-5) accumulators, tunables
+//
+// Precision: +, - are exact; * and / round to nearest (error <= 1/2 step, plus
+// the operands' own error). All arithmetic saturates at the format's range
+// instead of wrapping; division by zero saturates toward the dividend's sign.
+//
+// fromDouble()/toDouble() are constexpr for compile-time constants, table
+// generators and tests - runtime code uses fromInt/fromRatio/fromRaw.
+template <typename STORAGE, typename WIDE, int FRAC_BITS>
+struct Fixed {
+    static constexpr int FRAC = FRAC_BITS;
+    static constexpr WIDE ONE = (WIDE)1 << FRAC_BITS;      // Raw value of 1.0 (may be out of range)
+    static constexpr WIDE RAW_MIN = std::numeric_limits<STORAGE>::min();
+    static constexpr WIDE RAW_MAX = std::numeric_limits<STORAGE>::max();
+
+    STORAGE raw;
+
+    // Construction
+    static constexpr Fixed fromRaw(STORAGE r) { return Fixed{r}; }
+    static constexpr Fixed fromInt(WIDE i) { return saturate(i * ONE); }
+    static constexpr Fixed fromRatio(WIDE num, WIDE den) { return saturate(divRound(num * ONE, den)); }
+    static constexpr Fixed fromDouble(double d) {
+        return saturate((WIDE)(d * ONE + (d < 0 ? -0.5 : 0.5)));
+    }
+    static constexpr Fixed min() { return Fixed{(STORAGE)RAW_MIN}; }
+    static constexpr Fixed max() { return Fixed{(STORAGE)RAW_MAX}; }
+
+    // Conversion
+    constexpr WIDE toInt() const { return (WIDE)raw >> FRAC_BITS; }                              // Floor
+    constexpr WIDE round() const { return ((WIDE)raw + (ONE >> 1)) >> FRAC_BITS; }               // Nearest
+    constexpr uint8_t frac8() const { return (uint8_t)(((WIDE)raw & (ONE - 1)) >> (FRAC_BITS - 8)); }  // Fraction as 0-255
+    constexpr double toDouble() const { return (double)raw / ONE; }
+
+    // Scale an integer by this value: value * this, rounded to nearest
+    constexpr WIDE scale(WIDE value) const { return ((WIDE)value * raw + (ONE >> 1)) >> FRAC_BITS; }
+
+    // Saturating arithmetic
+    constexpr Fixed operator+(Fixed o) const { return saturate((WIDE)raw + o.raw); }
+    constexpr Fixed operator-(Fixed o) const { return saturate((WIDE)raw - o.raw); }
+    constexpr Fixed operator*(Fixed o) const { return saturate(((WIDE)raw * o.raw + (ONE >> 1)) >> FRAC_BITS); }
+    constexpr Fixed operator/(Fixed o) const {
+        return o.raw == 0 ? (raw < 0 ? min() : max()) : saturate(divRound((WIDE)raw * ONE, o.raw));
+    }
+    Fixed& operator+=(Fixed o) { return *this = *this + o; }
+    Fixed& operator-=(Fixed o) { return *this = *this - o; }
+    Fixed& operator*=(Fixed o) { return *this = *this * o; }
+
+    // Comparison
+    constexpr bool operator==(Fixed o) const { return raw == o.raw; }
+    constexpr bool operator!=(Fixed o) const { return raw != o.raw; }
+    constexpr bool operator<(Fixed o) const { return raw < o.raw; }
+    constexpr bool operator<=(Fixed o) const { return raw <= o.raw; }
+    constexpr bool operator>(Fixed o) const { return raw > o.raw; }
+    constexpr bool operator>=(Fixed o) const { return raw >= o.raw; }
+
+private:
+    static constexpr Fixed saturate(WIDE v) {
+        return Fixed{(STORAGE)(v < RAW_MIN ? RAW_MIN : v > RAW_MAX ? RAW_MAX : v)};
+    }
+
+    // Integer division rounded to nearest (half away from zero)
+    static constexpr WIDE divRound(WIDE num, WIDE den) {
+        return ((num < 0) == (den < 0)) ? (num + den / 2) / den : (num - den / 2) / den;
+    }
+};
+
+typedef Fixed<uint8_t, int32_t, 8> Q0_8;
+typedef Fixed<int16_t, int32_t, 8> Q8_8;
+typedef Fixed<int32_t, int64_t, 16> Q16_16;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Shared frame clock
+// Sampled once at the top of loop() so every subsystem sees the same timestamp
+// for the current iteration (notifications, animations, button handling)
+class FrameClock {
+public:
+    FrameClock() : nowMs(0), deltaMs(0), frameCount(0) {}
+
+    // Advance the clock (call once per loop iteration)
+    void tick(unsigned long timestampMs) {
+        deltaMs = (frameCount == 0) ? 0 : timestampMs - nowMs;
+        nowMs = timestampMs;
+        frameCount++;
+    }
+
+    unsigned long now() const { return nowMs; }        // Timestamp of current iteration
+    unsigned long delta() const { return deltaMs; }    // Milliseconds since previous tick
+    uint32_t frame() const { return frameCount; }      // Number of ticks so far
+
+private:
+    unsigned long nowMs;
+    unsigned long deltaMs;
+    uint32_t frameCount;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// One run of consecutive canvas pixels placed on a physical channel
+struct SegmentRun {
+    uint8_t segment;        // Canvas segment
+    uint16_t segmentStart;  // First segment pixel of the run
+    uint8_t channel;        // Physical channel (0-based)
+    uint16_t channelStart;  // LED on the channel that shows segmentStart
+    uint16_t count;         // Number of LEDs
+    bool reversed;          // Run heads toward the channel start (segmentStart at channelStart, then down)
+};
+
+// Logical LED canvas mapped onto the physical channels
+//
+// Animations render SEGMENTS segments of SEGMENT_LEDS pixels each without
+// knowing how the strips are wired. A layout places segments onto physical
+// channel ranges as a list of runs, so a segment can span several channels
+// (one 800-pixel run across four 200-LED strips) or a channel can be split
+// into zones (two 100-pixel segments per strip).
+//
+// The layout is compiled once into a per-LED index table; gather() then fills
+// every physical LED with one table lookup - no per-pixel address math in the
+// animations. Physical LEDs not covered by any run stay black.
+template <uint8_t SEGMENTS, uint16_t SEGMENT_LEDS, uint8_t CHANNELS, uint16_t LEDS>
+class LedCanvas {
+public:
+    static constexpr uint32_t CANVAS_PIXELS = (uint32_t)SEGMENTS * SEGMENT_LEDS;
+    static constexpr uint32_t PHYSICAL_PIXELS = (uint32_t)CHANNELS * LEDS;
+    static constexpr uint16_t UNMAPPED = 0xFFFF;
+    static_assert(CANVAS_PIXELS < UNMAPPED, "Canvas too large for 16-bit index table");
+
+    // Default layout: canvas pixels laid end to end over the channels in order
+    // (identity when segments match channels)
+    LedCanvas() {
+        for (uint8_t s = 0; s < SEGMENTS; s++) {
+            segmentPtrs[s] = pixels[s];
+        }
+        for (uint32_t p = 0; p < PHYSICAL_PIXELS; p++) {
+            sourceIndex[p] = (p < CANVAS_PIXELS) ? (uint16_t)p : UNMAPPED;
+        }
+        for (uint8_t s = 0; s < SEGMENTS; s++) {
+            owner[s] = (uint8_t)((uint32_t)s * SEGMENT_LEDS / LEDS);
+            if (owner[s] >= CHANNELS) owner[s] = CHANNELS - 1;
+        }
+    }
+
+    // Compile a layout into the index table
+    // Returns false (and keeps the current layout) if a run falls outside the
+    // canvas or the strips
+    bool setLayout(const SegmentRun* runs, uint8_t numRuns) {
+        for (uint8_t r = 0; r < numRuns; r++) {
+            if (!validRun(runs[r])) return false;
+        }
+
+        for (uint32_t p = 0; p < PHYSICAL_PIXELS; p++) {
+            sourceIndex[p] = UNMAPPED;
+        }
+        for (uint8_t s = 0; s < SEGMENTS; s++) {
+            owner[s] = CHANNELS;
+        }
+
+        for (uint8_t r = 0; r < numRuns; r++) {
+            const SegmentRun& run = runs[r];
+            for (uint16_t i = 0; i < run.count; i++) {
+                uint16_t led = run.reversed ? run.channelStart - i : run.channelStart + i;
+                sourceIndex[(uint32_t)run.channel * LEDS + led] = (uint16_t)(run.segment * SEGMENT_LEDS + run.segmentStart + i);
+            }
+
+            // A segment takes its HomeKit state from the channel showing its first pixel
+            if (owner[run.segment] == CHANNELS || run.segmentStart == 0) {
+                owner[run.segment] = run.channel;
+            }
+        }
+
+        for (uint8_t s = 0; s < SEGMENTS; s++) {
+            if (owner[s] == CHANNELS) owner[s] = 0;  // Segment not shown anywhere
+        }
+        return true;
+    }
+
+    template <size_t N>
+    bool setLayout(const SegmentRun (&runs)[N]) {
+        static_assert(N <= 255, "Too many layout runs");
+        return setLayout(runs, (uint8_t)N);
+    }
+
+    // Segment arrays for AnimationBase<SEGMENTS, SEGMENT_LEDS>::render()
+    CRGB* const* segments() const { return segmentPtrs; }
+
+    // Physical channel whose HomeKit state drives a segment
+    uint8_t ownerChannel(uint8_t segment) const { return owner[segment]; }
+
+    // Copy the canvas onto the physical channels (one pass over the LEDs)
+    void gather(CRGB* const channels[CHANNELS]) const {
+        const CRGB* src = &pixels[0][0];
+        const uint16_t* index = sourceIndex;
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            CRGB* dst = channels[ch];
+            for (uint16_t i = 0; i < LEDS; i++) {
+                uint16_t s = *index++;
+                dst[i] = (s == UNMAPPED) ? CRGB::Black : src[s];
+            }
+        }
+    }
+
+private:
+    CRGB pixels[SEGMENTS][SEGMENT_LEDS];
+    CRGB* segmentPtrs[SEGMENTS];
+    uint16_t sourceIndex[PHYSICAL_PIXELS];    // Canvas pixel shown by each physical LED
+    uint8_t owner[SEGMENTS];
+
+    static bool validRun(const SegmentRun& run) {
+        if (run.segment >= SEGMENTS || run.channel >= CHANNELS || run.count == 0) return false;
+        if ((uint32_t)run.segmentStart + run.count > SEGMENT_LEDS) return false;
+        if (run.reversed) return run.channelStart < LEDS && run.channelStart + 1 >= run.count;
+        return (uint32_t)run.channelStart + run.count <= LEDS;
+    }
+};
@@ -3,6 +3,7 @@
 #include "HomeSpan.h"
 #include <FastLED.h>
 #include "channel_storage.h"
+#include "lookup_table.h"
 #include "config.h"
 
 // LED Channel State Machine
@@ -29,6 +30,7 @@ struct DEV_LedChannel : Service::LightBulb {
     ChannelState currentState = ChannelState::NORMAL;
     unsigned long stateEnteredMs = 0;
     bool pendingHomeKitSync = false;
+    bool pendingSave = false;            // Desired state changed since last NVS write
 
     // Desired state (what we want to show when not in NOTIFICATION/BOOT_FLASH)
     struct {
@@ -83,9 +85,9 @@ struct DEV_LedChannel : Service::LightBulb {
             // Light is ON - convert HomeKit HSV to FastLED CHSV
             // HomeKit: H=0-360, S=0-100, V=0-100
             // FastLED CHSV: H=0-255, S=0-255, V=0-255
-            uint8_t h_8 = map(h, 0, 360, 0, 255);
-            uint8_t s_8 = map(s, 0, 100, 0, 255);
-            uint8_t v_8 = map(v, 0, 100, 0, 255);
+            uint8_t h_8 = hue8FromDegrees(h);
+            uint8_t s_8 = U8_FROM_PERCENT[constrain(s, 0, 100)];
+            uint8_t v_8 = U8_FROM_PERCENT[constrain(v, 0, 100)];
 
             // Fill all LEDs with the color (FastLED handles HSV→RGB conversion)
             fill_solid(leds, numLeds, CHSV(h_8, s_8, v_8));
@@ -211,13 +213,8 @@ struct DEV_LedChannel : Service::LightBulb {
             Serial.printf("Channel %d updated: Power OFF\n", channelNumber);
         }
 
-        // Save state to NVS
-        ChannelStorage::ChannelState state;
-        state.power = powerOn;
-        state.hue = h;
-        state.saturation = s;
-        state.brightness = clampedBrightness;
-        storage.save(state);
+        // Save state to NVS (deferred to flushStorage() so slider drags coalesce into one write)
+        pendingSave = true;
 
         // Transition to appropriate state
         if (currentState == ChannelState::NORMAL || currentState == ChannelState::OFF) {
@@ -231,8 +228,22 @@ struct DEV_LedChannel : Service::LightBulb {
         return true;  // Return true to indicate successful update
     }
 
+    // Write desired state to NVS if it changed (called periodically by the loop scheduler)
+    void flushStorage() {
+        if (!pendingSave) return;
+        pendingSave = false;
+
+        ChannelStorage::ChannelState state;
+        state.power = desired.power;
+        state.hue = desired.hue;
+        state.saturation = desired.saturation;
+        state.brightness = desired.brightness;
+        storage.save(state);
+    }
+
     // Clear this channel's NVS storage (used during factory reset)
     void clearStorage() {
+        pendingSave = false;
         storage.clear();
         Serial.printf("Channel %d: Storage cleared\n", channelNumber);
     }
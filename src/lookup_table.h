@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Compile-time lookup tables
+// Tables are produced by constexpr generators and stored as constexpr data, so
+// they live in flash (rodata): no boot-time computation and no float math at
+// runtime. Generators may use double freely - only the compiler evaluates them.
+//
+// Usage:
+//   constexpr Lut<uint8_t, 256> SQUARE = makeLut<uint8_t, 256>([](size_t i) {
+//       return (uint8_t)((i * i) / 255);
+//   });
+//   uint8_t y = SQUARE[x];
+template <typename T, size_t N>
+struct Lut {
+    T data[N];
+
+    constexpr const T& operator[](size_t i) const { return data[i]; }
+    static constexpr size_t size() { return N; }
+};
+
+// Build a table by evaluating fn(i) for every index
+template <typename T, size_t N, typename Fn>
+constexpr Lut<T, N> makeLut(Fn fn) {
+    Lut<T, N> lut{};
+    for (size_t i = 0; i < N; i++) {
+        lut.data[i] = fn(i);
+    }
+    return lut;
+}
+
+// constexpr math for table generators (not for runtime use)
+namespace lutmath {
+
+// e^x: halve x into [-0.5, 0.5], Taylor series, then square back
+constexpr double exp(double x) {
+    int halvings = 0;
+    while (x > 0.5 || x < -0.5) {
+        x /= 2.0;
+        halvings++;
+    }
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 16; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    for (int i = 0; i < halvings; i++) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+// Natural log (x > 0): scale into [1, 2), then 2*atanh((m-1)/(m+1)) series
+constexpr double log(double x) {
+    constexpr double LN2 = 0.693147180559945309;
+    int exponent = 0;
+    while (x >= 2.0) { x /= 2.0; exponent++; }
+    while (x < 1.0) { x *= 2.0; exponent--; }
+    double y = (x - 1.0) / (x + 1.0);
+    double y2 = y * y;
+    double sum = 0.0;
+    double term = y;
+    for (int n = 1; n < 40; n += 2) {
+        sum += term / n;
+        term *= y2;
+    }
+    return exponent * LN2 + 2.0 * sum;
+}
+
+// base^e (base >= 0)
+constexpr double pow(double base, double e) {
+    return (base <= 0.0) ? 0.0 : exp(e * log(base));
+}
+
+// Round a 0.0-1.0 fraction to 0-255, clamped
+constexpr uint8_t toU8(double fraction) {
+    double v = fraction * 255.0 + 0.5;
+    return (v <= 0.0) ? 0 : (v >= 255.0) ? 255 : (uint8_t)v;
+}
+
+}  // namespace lutmath
+
+// Gamma curve: out = 255 * (in/255)^gamma
+constexpr Lut<uint8_t, 256> makeGammaLut(double gamma) {
+    return makeLut<uint8_t, 256>([gamma](size_t i) {
+        return lutmath::toU8(lutmath::pow(i / 255.0, gamma));
+    });
+}
+
+// Gamma curve at 16-bit output precision (for dithering back down to 8 bits)
+constexpr Lut<uint16_t, 256> makeGammaLut16(double gamma) {
+    return makeLut<uint16_t, 256>([gamma](size_t i) {
+        double v = lutmath::pow(i / 255.0, gamma) * 65535.0 + 0.5;
+        return (uint16_t)(v >= 65535.0 ? 65535 : v);
+    });
+}
+
+// HomeKit hue degrees (0-360) -> FastLED hue (0-255), same rounding as map()
+inline constexpr Lut<uint8_t, 361> HUE8_FROM_DEGREES = makeLut<uint8_t, 361>([](size_t deg) {
+    return (uint8_t)(deg * 255 / 360);
+});
+
+// HomeKit percentage (0-100) -> 0-255 (linear brightness/saturation curve, same as map())
+inline constexpr Lut<uint8_t, 101> U8_FROM_PERCENT = makeLut<uint8_t, 101>([](size_t pct) {
+    return (uint8_t)(pct * 255 / 100);
+});
+
+// Cubic bias: 255 * (i/255)^3 - random index in, skewed value out
+inline constexpr Lut<uint8_t, 256> CUBIC_BIAS8 = makeLut<uint8_t, 256>([](size_t i) {
+    double r = i / 255.0;
+    return lutmath::toU8(r * r * r);
+});
+
+// Perceptual gamma (2.2) for the output stage
+inline constexpr Lut<uint8_t, 256> GAMMA8 = makeGammaLut(2.2);
+inline constexpr Lut<uint16_t, 256> GAMMA16 = makeGammaLut16(2.2);
+
+// Hue degrees (any int, wrapped into 0-359) -> FastLED hue
+inline uint8_t hue8FromDegrees(int hue360) {
+    return HUE8_FROM_DEGREES[((hue360 % 360) + 360) % 360];
+}
@@ -4,26 +4,65 @@
 #include "config.h"
 #include "led_channel.h"
 #include "wifi_credentials.h"
-#include "notification_pattern.h"
+#include "frame_clock.h"
+#include "button_input.h"
+#include "task_scheduler.h"
+#include "notification_manager.h"
 #include "animation/animation_manager.h"
+#include "power_limiter.h"
+#include "output/output_stage.h"
+#include "output/frame_interpolator.h"
+#include "output/fastled_output.h"
+#include "output/rmt_parallel_output.h"
 
-// LED Arrays for all channels
-CRGB ledChannel1[NUM_LEDS_PER_CHANNEL];        // WS2811 on GPIO 26
-CRGB ledChannel2[NUM_LEDS_PER_CHANNEL];        // WS2811 on GPIO 18
-CRGB ledChannel3[NUM_LEDS_PER_CHANNEL];        // WS2811 on GPIO 25
-CRGB ledChannel4[NUM_LEDS_PER_CHANNEL];        // WS2811 on GPIO 19
+// LED Arrays for all channels (WS2811, data pins in PIN_LED_CHANNELS)
+CRGB ledChannels[NUM_CHANNELS][NUM_LEDS_PER_CHANNEL];
+CRGB* ledStrips[NUM_CHANNELS];                 // Per-channel pointers (filled in setup)
+
+// Output-stage result actually sent to the strips (gamma, color correction, dithering)
+CRGB outputChannels[NUM_CHANNELS][NUM_LEDS_PER_CHANNEL];
+CRGB* outputStrips[NUM_CHANNELS];
 
 // LED Channel service instances (for boot flash handling)
-DEV_LedChannel* channel1Service = nullptr;
-DEV_LedChannel* channel2Service = nullptr;
-DEV_LedChannel* channel3Service = nullptr;
-DEV_LedChannel* channel4Service = nullptr;
+DEV_LedChannel* channelServices[NUM_CHANNELS] = {};
+
+// Managers sized to the configured hardware
+typedef NotificationManager<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL> LedNotificationManager;
+typedef AnimationManager<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL, NUM_SEGMENTS, NUM_LEDS_PER_SEGMENT> LedAnimationManager;
+typedef LedOutput<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL> LedStripOutput;
+
+// Shared frame clock (sampled once per loop iteration)
+FrameClock frameClock;
+
+// Cooperative loop scheduler (subsystems run at their own periods; loop sleeps in between)
+TaskScheduler loopScheduler(millis);
+int8_t renderTask = TaskScheduler::INVALID_TASK;
 
 // Notification manager for visual feedback
-NotificationManager* notificationMgr = nullptr;
+LedNotificationManager* notificationMgr = nullptr;
 
 // Animation manager for ambient animations
-AnimationManager* animationMgr = nullptr;
+LedAnimationManager* animationMgr = nullptr;
+
+// Output backend pushing ledChannels to the strips (LED_OUTPUT_BACKEND)
+LedStripOutput* ledOutput = nullptr;
+
+// Gamma, color correction and dithering between ledChannels and outputChannels
+OutputStage<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL> outputStage;
+
+// Output-rate blend between animation frames (OUTPUT_INTERPOLATION)
+FrameInterpolator<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL> frameInterpolator;
+
+// Strip current estimate and brightness limiter (POWER_BUDGET_MA)
+PowerLimiter<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL> powerLimiter(POWER_BUDGET_MA, LED_MA_PER_COLOR, LED_IDLE_UA);
+
+// Wire time of one frame with the channels sent one after another / all at once
+constexpr uint32_t SERIAL_FRAME_US = wire::frameUs(NUM_CHANNELS, NUM_LEDS_PER_CHANNEL, 1);
+constexpr uint32_t PARALLEL_FRAME_US = wire::frameUs(NUM_CHANNELS, NUM_LEDS_PER_CHANNEL, NUM_CHANNELS);
+
+// Interrupt-driven button inputs (edges timestamped in the ISR, debounced in loop)
+ButtonInput resetButton(PIN_BUTTON, DEBOUNCE_MS);      // GPIO39: Factory reset
+ButtonInput animButton(PIN_BUTTON_ANIM, DEBOUNCE_MS);  // GPIO0: Animation cycling
 
 // Button state machine for factory reset (GPIO39)
 enum ButtonState {
@@ -37,11 +76,9 @@ enum ButtonState {
 
 ButtonState buttonState = BTN_IDLE;
 unsigned long buttonPressStartMs = 0;
-unsigned long confirmStartMs = 0;
-bool buttonLastState = HIGH;  // GPIO39 is pulled high, LOW when pressed
+uint16_t resetNotificationId = 0;  // Queued notification the reset flow is waiting on
 bool buttonReleasedDuringAnimation = false;  // Track if button was released during 3x sequence
 uint8_t currentDisplayMode = 0;  // For display mode cycling
-bool animButtonLastState = HIGH;  // GPIO0 is pulled high, LOW when pressed
 
 // Animation button state machine
 enum AnimButtonState {
@@ -52,6 +89,7 @@ AnimButtonState animButtonState = ANIM_BTN_IDLE;
 unsigned long animButtonPressStartMs = 0;
 
 // Forward declaration
+void showLeds(const CRGB* const frame[NUM_CHANNELS] = ledStrips);
 void blankAllLEDs();
 void applyChannelDefaults();
 void updateAnimationButton();
@@ -63,28 +101,10 @@ void handleShortPress() {
     // TODO: Implement actual display mode logic (placeholder for beads-4vz)
 }
 
-// Update animation button (GPIO0) - state machine with long press support
-void updateAnimationButton() {
-    bool currentButtonState = digitalRead(PIN_BUTTON_ANIM);
-    unsigned long now = millis();
-
-    // Debounce
-    static unsigned long lastDebounceTime = 0;
-    if ((now - lastDebounceTime) < DEBOUNCE_MS) {
-        return;
-    }
-
-    // Detect button press/release edges
-    bool buttonPressed = (currentButtonState == LOW);
-    bool buttonJustPressed = (buttonPressed && animButtonLastState == HIGH);
-    bool buttonJustReleased = (!buttonPressed && animButtonLastState == LOW);
-
-    if (buttonJustPressed || buttonJustReleased) {
-        lastDebounceTime = now;
-    }
-
-    animButtonLastState = currentButtonState;
-
+// Animation button (GPIO0) state machine step
+// Called once per debounced edge (with the edge timestamp) and once per loop
+// with no edge for the long-press timeout
+void stepAnimationButton(bool buttonJustPressed, bool buttonJustReleased, unsigned long now) {
     // State machine logic
     switch (animButtonState) {
         case ANIM_BTN_IDLE:
@@ -97,7 +117,7 @@ void updateAnimationButton() {
 
         case ANIM_BTN_PRESSED:
             // Check if long press threshold reached
-            if (buttonPressed && (now - animButtonPressStartMs) >= ANIM_BUTTON_LONG_PRESS_MS) {
+            if (animButton.heldFor(now) >= ANIM_BUTTON_LONG_PRESS_MS) {
                 // Long press: reset to defaults immediately
                 Serial.println("Animation button long press - resetting to defaults");
                 applyChannelDefaults();
@@ -121,23 +141,32 @@ void updateAnimationButton() {
     }
 }
 
+// Update animation button (GPIO0) - state machine with long press support
+void updateAnimationButton() {
+    unsigned long now = frameClock.now();
+    ButtonEvent event;
+    while (animButton.poll(now, event)) {
+        stepAnimationButton(event.type == BUTTON_PRESSED, event.type == BUTTON_RELEASED, event.timestampMs);
+    }
+    stepAnimationButton(false, false, now);
+}
+
 // Handle factory reset trigger
 void handleFactoryReset() {
     Serial.println("FACTORY RESET TRIGGERED!");
 
     // Clear all channel storage (colors, brightness, power state)
     Serial.println("Clearing channel state...");
-    if (channel1Service) channel1Service->clearStorage();
-    if (channel2Service) channel2Service->clearStorage();
-    if (channel3Service) channel3Service->clearStorage();
-    if (channel4Service) channel4Service->clearStorage();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (channelServices[ch]) channelServices[ch]->clearStorage();
+    }
 
     // Clear animation mode storage
     if (animationMgr) animationMgr->clearStorage();
 
     // Blank all LEDs for visual feedback
     blankAllLEDs();
-    FastLED.show();
+    showLeds();
 
     Serial.println("Erasing HomeKit pairings and rebooting...");
 
@@ -149,11 +178,10 @@ void handleFactoryReset() {
 
 // Blank all LEDs in preparation for notification
 void blankAllLEDs() {
-    fill_solid(ledChannel1, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel2, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel3, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel4, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    FastLED.show();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        fill_solid(ledChannels[ch], NUM_LEDS_PER_CHANNEL, CRGB::Black);
+    }
+    showLeds();
 }
 
 // Apply channel defaults and validate NVS state
@@ -213,27 +241,11 @@ void applyChannelDefaults() {
 }
 
 
-// Update button state machine
-void updateButtonStateMachine() {
-    bool currentButtonState = digitalRead(PIN_BUTTON);
-    unsigned long now = millis();
-
-    // Debounce
-    static unsigned long lastDebounceTime = 0;
-    if ((now - lastDebounceTime) < DEBOUNCE_MS) {
-        return;
-    }
-
-    // Detect button press/release edges
-    bool buttonPressed = (currentButtonState == LOW);
-    bool buttonJustPressed = (buttonPressed && buttonLastState == HIGH);
-    bool buttonJustReleased = (!buttonPressed && buttonLastState == LOW);
-
-    if (buttonJustPressed || buttonJustReleased) {
-        lastDebounceTime = now;
-    }
-
-    buttonLastState = currentButtonState;
+// Factory reset button (GPIO39) state machine step
+// Called once per debounced edge (with the edge timestamp) and once per loop
+// with no edge for time-based transitions
+void stepButtonStateMachine(bool buttonJustPressed, bool buttonJustReleased, unsigned long now) {
+    bool buttonPressed = resetButton.isPressed();
 
     // State machine logic
     switch (buttonState) {
@@ -253,7 +265,7 @@ void updateButtonStateMachine() {
                     handleShortPress();
                 }
                 buttonState = BTN_IDLE;
-            } else if ((now - buttonPressStartMs) >= FACTORY_RESET_WARNING_MS) {
+            } else if (resetButton.heldFor(now) >= FACTORY_RESET_WARNING_MS) {
                 // Held for 5s - enter notification state
                 buttonState = BTN_NOTIFICATION;
                 buttonReleasedDuringAnimation = false;  // Reset flag
@@ -262,9 +274,10 @@ void updateButtonStateMachine() {
                 // Blank ALL LEDs before starting animation
                 blankAllLEDs();
 
-                // Start warning animation (3 complete cycles)
+                // Queue warning animation (3 complete cycles)
                 // ~300ms per step = ~2.4s per cycle, ~7.2s total for 3 cycles
-                notificationMgr->start(PATTERN_WARNING, CRGB::Red, 300, 3);
+                resetNotificationId = notificationMgr->enqueue(
+                    {PATTERN_WARNING, CRGB::Red, 3, 0, PRIORITY_CRITICAL}, frameClock.now());
             }
             break;
 
@@ -276,32 +289,30 @@ void updateButtonStateMachine() {
             }
 
             // Check if animation completed (3 cycles done)
-            if (notificationMgr->getCycleCount() >= 3) {
-                notificationMgr->stop();
-
+            if (!notificationMgr->isPending(resetNotificationId)) {
                 if (buttonReleasedDuringAnimation || !buttonPressed) {
                     // Button was released during animation - show green confirmation
                     Serial.println("Animation complete - reset cancelled (button was released)");
                     buttonState = BTN_CANCELLED_CONFIRM;
-                    confirmStartMs = now;
                     buttonReleasedDuringAnimation = false;
 
-                    // Show green confirmation
-                    notificationMgr->start(PATTERN_SOLID, CRGB::Green, 0, 0);
+                    // Queue green confirmation (solid for 3 seconds)
+                    resetNotificationId = notificationMgr->enqueue(
+                        {PATTERN_SOLID, CRGB::Green, 0, FACTORY_RESET_CONFIRM_MS, PRIORITY_CRITICAL}, frameClock.now());
                 } else {
                     // Button still held - show red confirmation for 3s before reset
                     Serial.println("Animation complete - button still held, showing red confirmation");
                     buttonState = BTN_RESET_CONFIRM;
-                    confirmStartMs = now;
 
-                    // Show red confirmation (solid for 3 seconds)
-                    notificationMgr->start(PATTERN_SOLID, CRGB::Red, 0, 0);
+                    // Queue red confirmation (solid for 3 seconds)
+                    resetNotificationId = notificationMgr->enqueue(
+                        {PATTERN_SOLID, CRGB::Red, 0, FACTORY_RESET_CONFIRM_MS, PRIORITY_CRITICAL}, frameClock.now());
                 }
             }
             break;
 
         case BTN_RESET_CONFIRM:
-            if ((now - confirmStartMs) >= FACTORY_RESET_CONFIRM_MS) {
+            if (!notificationMgr->isPending(resetNotificationId)) {
                 // 3 seconds elapsed - initiate factory reset
                 Serial.println("Red confirmation complete - initiating factory reset");
                 buttonState = BTN_RESET;
@@ -310,10 +321,9 @@ void updateButtonStateMachine() {
             break;
 
         case BTN_CANCELLED_CONFIRM:
-            if ((now - confirmStartMs) >= FACTORY_RESET_CONFIRM_MS) {
-                // 3 seconds elapsed - restore previous state and resume
+            if (!notificationMgr->isPending(resetNotificationId)) {
+                // 3 seconds elapsed - notification manager restores previous state
                 Serial.println("Resuming normal operation");
-                notificationMgr->stop();
                 buttonState = BTN_IDLE;
             }
             break;
@@ -324,6 +334,139 @@ void updateButtonStateMachine() {
     }
 }
 
+// Update button state machine
+void updateButtonStateMachine() {
+    unsigned long now = frameClock.now();
+    ButtonEvent event;
+    while (resetButton.poll(now, event)) {
+        stepButtonStateMachine(event.type == BUTTON_PRESSED, event.type == BUTTON_RELEASED, event.timestampMs);
+    }
+    stepButtonStateMachine(false, false, now);
+}
+
+// ========== Loop Scheduler Tasks ==========
+
+// Button edge queues -> state machines
+void taskButtons() {
+    updateButtonStateMachine();      // GPIO39: Factory reset
+    updateAnimationButton();         // GPIO0: Animation cycling
+}
+
+// Notification and animation frame updates
+void taskRender() {
+    // Update queued notifications (highest priority, non-blocking)
+    // Completion is observed by the state machine via isPending()
+    notificationMgr->update(frameClock.now());
+
+    // Update ambient animations if active (only if notifications not active)
+    // A frame still in progress resumes on the next loop pass, after the other due tasks
+    if (!notificationMgr->isActive() && animationMgr->isActive()) {
+        if (animationMgr->update()) loopScheduler.wake(renderTask);
+    }
+
+    // Update FSM state for all channels
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (channelServices[ch]) channelServices[ch]->updateFSM();
+    }
+}
+
+// Poll HomeSpan for HomeKit events
+void taskHomeSpan() {
+    homeSpan.poll();
+}
+
+// Push LED arrays to the strips
+void taskOutput() {
+    // Notifications and HomeKit write ledChannels directly
+    if (notificationMgr->isActive() || !animationMgr->isActive()) {
+        frameInterpolator.reset();
+        showLeds();
+        return;
+    }
+
+    // Map the animation canvas onto the strips
+    // Animations run at their own frame rate: without dithering to refresh,
+    // a frame that has not changed is not sent again
+    bool newFrame = animationMgr->present();
+    if (OUTPUT_INTERPOLATION) {
+        // Blend from the frame on display to the newest one over one animation frame
+        if (newFrame) frameInterpolator.push(ledStrips, frameClock.now(), animationMgr->getFrameIntervalMs());
+        bool changed = newFrame || !frameInterpolator.settled();
+        if (!frameInterpolator.render(frameClock.now())) return;
+        if (!changed && !OUTPUT_DITHERING) return;
+        showLeds(frameInterpolator.channels());
+        return;
+    }
+    if (!newFrame && !OUTPUT_DITHERING) return;
+    showLeds();
+}
+
+// Run the output stage over a frame (ledChannels by default) and send the result
+// The stage applies the power-limited brightness and sums the frame for the
+// next limit; if this frame alone breaks the budget it is redone at once.
+void showLeds(const CRGB* const frame[NUM_CHANNELS]) {
+    uint32_t channelSums[NUM_CHANNELS];
+    uint8_t brightness = (powerLimiter.brightness() < LED_OUTPUT_BRIGHTNESS) ? powerLimiter.brightness() : LED_OUTPUT_BRIGHTNESS;
+    outputStage.process(frame, outputStrips, brightness, channelSums);
+
+    powerLimiter.setChannelSums(channelSums);
+    uint8_t limited = powerLimiter.limit(LED_OUTPUT_BRIGHTNESS);
+    if (limited < brightness) {
+        outputStage.process(frame, outputStrips, limited, channelSums);
+    }
+
+    ledOutput->show();
+    outputStage.nextFrame();
+}
+
+// Coalesced NVS writes of channel state
+void taskPersistence() {
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (channelServices[ch]) channelServices[ch]->flushStorage();
+    }
+}
+
+// Periodic scheduler telemetry
+void taskSchedulerStats() {
+    Serial.printf("Loop scheduler: %d%% idle\n", loopScheduler.idlePercent());
+    loopScheduler.resetStats();
+
+    // Time-sliced animation frames: longest single render run vs the budget
+    Serial.printf("Animation slices: %lu runs, longest %lu us (budget %lu us)\n",
+                  (unsigned long)animationMgr->getSliceRuns(), (unsigned long)animationMgr->getMaxSliceRunUs(),
+                  (unsigned long)ANIMATION_SLICE_BUDGET_US);
+    animationMgr->resetSliceStats();
+    if (animationMgr->isActive()) {
+        Serial.printf("Animation: every %lu ms, quality level %d/%d, frame %lu us (budget %lu us)\n",
+                      animationMgr->getFrameIntervalMs(), animationMgr->getQualityLevel(), animationMgr->getQualityLevels() - 1,
+                      (unsigned long)animationMgr->getAverageFrameUs(), (unsigned long)ANIMATION_FRAME_BUDGET_US);
+    }
+
+    // Measured show() vs the wire model: tells whether channels go out serially or in parallel
+    Serial.printf("LED output (%s): show %lu us, wire %lu us serial / %lu us parallel (max %lu / %lu fps)\n",
+                  ledOutput->getName(), (unsigned long)ledOutput->lastShowUs(),
+                  (unsigned long)SERIAL_FRAME_US, (unsigned long)PARALLEL_FRAME_US,
+                  (unsigned long)wire::maxFps(SERIAL_FRAME_US), (unsigned long)wire::maxFps(PARALLEL_FRAME_US));
+
+    // Strip current: unlimited estimate vs what the limiter lets through
+    Serial.printf("Power: %lu mA requested, %lu mA output (budget %lu mA, brightness %d/%d)\n",
+                  (unsigned long)powerLimiter.estimatedMa(LED_OUTPUT_BRIGHTNESS), (unsigned long)powerLimiter.limitedMa(),
+                  (unsigned long)powerLimiter.getBudgetMa(), powerLimiter.brightness(), LED_OUTPUT_BRIGHTNESS);
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        Serial.printf("  Ch%d: %lu mA\n", ch + 1, (unsigned long)powerLimiter.channelMa(ch, powerLimiter.brightness()));
+    }
+}
+
+// Construct the configured output backend
+template <LedOutputBackend BACKEND = LED_OUTPUT_BACKEND>
+LedStripOutput* createOutput() {
+    if constexpr (BACKEND == OUTPUT_PARALLEL_RMT) {
+        return new ParallelRmtOutput<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL>();
+    } else {
+        return new FastLedOutput<NUM_CHANNELS, NUM_LEDS_PER_CHANNEL>();
+    }
+}
+
 void setup() {
     // Initialize Serial for debugging
     Serial.begin(115200);
@@ -331,40 +474,48 @@ void setup() {
 
     Serial.println("\n\n========================================");
     Serial.println("homekit-matchstick-sputter - Phase 2");
-    Serial.println("HomeKit Integration - 4 Light Channels");
+    Serial.printf("HomeKit Integration - %d Light Channels x %d LEDs\n", NUM_CHANNELS, NUM_LEDS_PER_CHANNEL);
     Serial.println("========================================");
 
-    // Initialize FastLED for all channels
-    FastLED.addLeds<WS2811, PIN_LED_CH1, GRB>(ledChannel1, NUM_LEDS_PER_CHANNEL);
-    FastLED.addLeds<WS2811, PIN_LED_CH2, GRB>(ledChannel2, NUM_LEDS_PER_CHANNEL);
-    FastLED.addLeds<WS2811, PIN_LED_CH3, GRB>(ledChannel3, NUM_LEDS_PER_CHANNEL);
-    FastLED.addLeds<WS2811, PIN_LED_CH4, GRB>(ledChannel4, NUM_LEDS_PER_CHANNEL);
+    // Initialize the LED output for all channels
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        ledStrips[ch] = ledChannels[ch];
+    }
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        outputStrips[ch] = outputChannels[ch];
+        outputStage.setCorrection(ch, CHANNEL_COLOR_CORRECTION[ch]);
+    }
+    outputStage.setDithering(OUTPUT_DITHERING);
+    ledOutput = createOutput();
+    ledOutput->begin(outputStrips);
 
-    // Set brightness (25% for safe testing)
-    FastLED.setBrightness(64);
+    // Brightness is applied by the output stage (LED_OUTPUT_BRIGHTNESS, power-limited)
+    ledOutput->setBrightness(255);
 
     // Initialize all LEDs to off
-    fill_solid(ledChannel1, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel2, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel3, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    fill_solid(ledChannel4, NUM_LEDS_PER_CHANNEL, CRGB::Black);
-    FastLED.show();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        fill_solid(ledChannels[ch], NUM_LEDS_PER_CHANNEL, CRGB::Black);
+    }
+    showLeds();
 
-    Serial.println("FastLED initialized.");
+    Serial.printf("LED output initialized (%s).\n", ledOutput->getName());
 
     // Initialize notification manager
-    notificationMgr = new NotificationManager(ledChannel1, ledChannel2, ledChannel3, ledChannel4);
+    notificationMgr = new LedNotificationManager(ledStrips);
     Serial.println("Notification manager initialized.");
 
     // Initialize animation manager
-    animationMgr = new AnimationManager(ledChannel1, ledChannel2, ledChannel3, ledChannel4, NUM_LEDS_PER_CHANNEL);
-    Serial.println("Animation manager initialized.");
+    animationMgr = new LedAnimationManager(ledStrips);
+    if (!animationMgr->setLayout(SEGMENT_LAYOUT)) {
+        Serial.println("Invalid SEGMENT_LAYOUT - using default canvas layout");
+    }
+    Serial.printf("Animation manager initialized (%d segments x %d LEDs).\n", NUM_SEGMENTS, NUM_LEDS_PER_SEGMENT);
 
-    // Initialize button pins
-    pinMode(PIN_BUTTON, INPUT_PULLUP);
-    Serial.println("Button pin configured (GPIO39 - factory reset).");
-    pinMode(PIN_BUTTON_ANIM, INPUT_PULLUP);
-    Serial.println("Button pin configured (GPIO0 - animation cycling).");
+    // Initialize button pins and edge interrupts
+    resetButton.begin();
+    Serial.println("Button interrupt configured (GPIO39 - factory reset).");
+    animButton.begin();
+    Serial.println("Button interrupt configured (GPIO0 - animation cycling).");
 
     // Initialize status LED pin
     pinMode(PIN_STATUS_LED, OUTPUT);
@@ -394,42 +545,26 @@ void setup() {
             new Characteristic::Model(DEVICE_MODEL);
             new Characteristic::FirmwareRevision(DEVICE_FIRMWARE);
 
-    // Create Channel 1 Accessory
-    new SpanAccessory();
-        new Service::AccessoryInformation();
-            new Characteristic::Identify();
-            new Characteristic::Name("Channel 1");
-        channel1Service = new DEV_LedChannel(ledChannel1, NUM_LEDS_PER_CHANNEL, 1);
-
-    // Create Channel 2 Accessory
-    new SpanAccessory();
-        new Service::AccessoryInformation();
-            new Characteristic::Identify();
-            new Characteristic::Name("Channel 2");
-        channel2Service = new DEV_LedChannel(ledChannel2, NUM_LEDS_PER_CHANNEL, 2);
-
-    // Create Channel 3 Accessory
-    new SpanAccessory();
-        new Service::AccessoryInformation();
-            new Characteristic::Identify();
-            new Characteristic::Name("Channel 3");
-        channel3Service = new DEV_LedChannel(ledChannel3, NUM_LEDS_PER_CHANNEL, 3);
+    // Create one Accessory per channel
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Channel %d", ch + 1);
 
-    // Create Channel 4 Accessory
-    new SpanAccessory();
-        new Service::AccessoryInformation();
-            new Characteristic::Identify();
-            new Characteristic::Name("Channel 4");
-        channel4Service = new DEV_LedChannel(ledChannel4, NUM_LEDS_PER_CHANNEL, 4);
+        new SpanAccessory();
+            new Service::AccessoryInformation();
+                new Characteristic::Identify();
+                new Characteristic::Name(name);
+            channelServices[ch] = new DEV_LedChannel(ledChannels[ch], NUM_LEDS_PER_CHANNEL, ch + 1);
+    }
 
     // Configure notification manager with channel services
-    notificationMgr->setChannelServices(channel1Service, channel2Service, channel3Service, channel4Service);
+    notificationMgr->setChannelServices(channelServices);
 
     // Configure animation manager with channel services
-    animationMgr->setChannelServices(channel1Service, channel2Service, channel3Service, channel4Service);
+    animationMgr->setChannelServices(channelServices);
 
     // Display boot flash colors for channels with brightness=0
-    FastLED.show();
+    showLeds();
 
     Serial.println("========================================");
     Serial.println("Setup complete!");
@@ -440,34 +575,28 @@ void setup() {
     // Turn on status LED to indicate device is active
     digitalWrite(PIN_STATUS_LED, HIGH);
     Serial.println("Status LED ON - device active");
+
+    // Register loop subsystems with the scheduler
+    loopScheduler.addTask("homespan", taskHomeSpan, HOMESPAN_POLL_PERIOD_MS);
+    loopScheduler.addTask("buttons", taskButtons, BUTTON_PERIOD_MS);
+    renderTask = loopScheduler.addTask("render", taskRender, RENDER_PERIOD_MS);
+    loopScheduler.addTask("output", taskOutput, OUTPUT_PERIOD_MS);
+    loopScheduler.addTask("persistence", taskPersistence, PERSISTENCE_PERIOD_MS);
+    loopScheduler.addTask("stats", taskSchedulerStats, SCHEDULER_STATS_PERIOD_MS);
+    Serial.println("Loop scheduler configured.");
 }
 
 void loop() {
-    // Update button state machine
-    updateButtonStateMachine();      // GPIO39: Factory reset
-    updateAnimationButton();         // GPIO0: Animation cycling
+    // Sample the shared frame clock once per iteration
+    frameClock.tick(millis());
 
-    // Update notification animations if active (highest priority)
-    if (notificationMgr->isActive()) {
-        bool stillRunning = notificationMgr->update(NUM_LEDS_PER_CHANNEL);
-        // Animation completion is now handled in the state machine
-        // (checking getCycleCount() in BTN_NOTIFICATION state)
-    }
+    // Run whatever is due, then sleep until the earliest deadline
+    // (delay() blocks in vTaskDelay, letting the FreeRTOS idle task run)
+    loopScheduler.runDue();
 
-    // Update ambient animations if active (only if notifications not active)
-    if (!notificationMgr->isActive() && animationMgr->isActive()) {
-        animationMgr->update();
+    unsigned long idleMs = loopScheduler.idleTime();
+    if (idleMs > 0) {
+        loopScheduler.noteIdle(idleMs);
+        delay(idleMs);
     }
-
-    // Update FSM state for all channels
-    if (channel1Service) channel1Service->updateFSM();
-    if (channel2Service) channel2Service->updateFSM();
-    if (channel3Service) channel3Service->updateFSM();
-    if (channel4Service) channel4Service->updateFSM();
-
-    // Poll HomeSpan for HomeKit events
-    homeSpan.poll();
-
-    // Update LED strips (called after every HomeSpan update)
-    FastLED.show();
 }
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "notification_scheduler.h"
+#include "led_channel.h"
+
+// Notification Manager
+// Owns the notification queue and coordinates with the channel services:
+// channels yield while any notification is queued, and the LED state
+// underneath is saved/restored around the queue becoming busy/idle.
+//
+// CHANNELS strips of LEDS LEDs each (keyframe channel masks cover up to 8)
+template <uint8_t CHANNELS, uint16_t LEDS>
+class NotificationManager {
+public:
+    static_assert(CHANNELS <= 8, "Keyframe channel masks cover at most 8 channels");
+
+    // channels: CHANNELS LED arrays of LEDS each
+    NotificationManager(CRGB* const channels[CHANNELS]) : engaged(false) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            this->channels[ch] = channels[ch];
+            channelServices[ch] = nullptr;
+        }
+    }
+
+    // Set channel service pointers (call after channel services are created)
+    void setChannelServices(DEV_LedChannel* const services[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            channelServices[ch] = services[ch];
+        }
+    }
+
+    // Queue a notification (non-blocking)
+    // Returns a handle for isPending()/cancel(), or 0 if the queue is full
+    uint16_t enqueue(const NotificationRequest& request, unsigned long now) {
+        uint16_t id = scheduler.enqueue(request, now);
+        if (id == 0) {
+            Serial.println("Notification queue full - request dropped");
+            return 0;
+        }
+        engage();
+        return id;
+    }
+
+    void cancel(uint16_t id) {
+        scheduler.cancel(id);
+    }
+
+    // Drop all queued notifications and restore channels immediately
+    void stop() {
+        scheduler.clear();
+        release();
+    }
+
+    // Advance the visible notification (call every frame with the shared clock)
+    // Channels are released one update after the queue drains, so a follow-up
+    // notification queued in response to a completion continues seamlessly
+    void update(unsigned long now) {
+        if (!engaged) return;
+
+        if (scheduler.isEmpty()) {
+            release();
+            return;
+        }
+
+        bool changed = scheduler.update(channels, CHANNELS, LEDS, now);
+        if (changed && scheduler.activeId() != 0) {
+            // Visible notification changed: clear the previous one's pixels, then draw
+            restoreSavedState();
+            scheduler.repaint(channels, CHANNELS, LEDS, now);
+        }
+    }
+
+    bool isPending(uint16_t id) const { return scheduler.isPending(id); }
+
+    // True while notifications own the LEDs
+    bool isActive() const { return engaged; }
+
+private:
+    NotificationScheduler scheduler;
+    CRGB* channels[CHANNELS];
+    DEV_LedChannel* channelServices[CHANNELS];
+    bool engaged;           // Channels yielded and LED state saved
+
+    // Storage for previous LED state (whole strips - keyframe regions may cover any range)
+    CRGB saved[CHANNELS][LEDS];
+
+    // Take over the LEDs when the queue goes from idle to busy
+    void engage() {
+        if (engaged) return;
+        engaged = true;
+
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            // Tell the channel service to yield to notification
+            if (channelServices[ch]) channelServices[ch]->yieldToNotification();
+
+            // Save current state
+            for (uint16_t i = 0; i < LEDS; i++) {
+                saved[ch][i] = channels[ch][i];
+            }
+        }
+    }
+
+    // Hand the LEDs back when the queue is idle
+    void release() {
+        if (!engaged) return;
+        engaged = false;
+
+        restoreSavedState();
+
+        // Tell all channel services to resume from notification
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            if (channelServices[ch]) channelServices[ch]->resumeFromNotification();
+        }
+    }
+
+    void restoreSavedState() {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            for (uint16_t i = 0; i < LEDS; i++) {
+                channels[ch][i] = saved[ch][i];
+            }
+        }
+    }
+};
@@ -3,261 +3,273 @@
 #include <Arduino.h>
 #include <FastLED.h>
 
-// Forward declaration
-struct DEV_LedChannel;
-
 // Notification pattern types
 enum NotificationPattern {
     PATTERN_NONE,           // No pattern (restore previous state)
     PATTERN_SOLID,          // Solid color on first 8 LEDs
     PATTERN_SEQUENTIAL,     // Sequential flash through first 8 LEDs
-    PATTERN_WARNING         // Warning pattern: blue base, one purple LED cycling
+    PATTERN_WARNING,        // Warning pattern: blue base, one purple LED cycling (factory reset)
+    PATTERN_IDENTIFY,       // HomeKit Identify: whole strips breathe in the notification color
+    PATTERN_WIFI_CONNECTING,// Slow blue pulse on channel 1, first LED
+    PATTERN_WIFI_CONNECTED, // Single green flash on channel 1, first 8 LEDs
+    PATTERN_PAIRING         // Amber pulse on the first 8 LEDs of every channel
+};
+
+// ========== Keyframe Format ==========
+//
+// A pattern is a flash-resident array of keyframes played in order; one pass
+// through the array is one cycle. Each keyframe paints a region (channel mask
+// + LED range) with a color, either instantly (EASE_STEP, then held for the
+// duration) or fading from the previous keyframe's color over the duration.
+//
+// Patterns should be self-contained per cycle (repaint after preemption
+// replays the current cycle only).
+
+// Keyframe easing curves
+enum KeyframeEasing : uint8_t {
+    EASE_STEP,              // Jump to the keyframe color, then hold for the duration
+    EASE_LINEAR,            // Linear fade from the previous keyframe color
+    EASE_IN_OUT             // Quadratic ease-in/ease-out fade
+};
+
+// Channel masks (bit 0 = channel 1)
+constexpr uint8_t KEYFRAME_CH1 = 0x01;
+constexpr uint8_t KEYFRAME_CH2 = 0x02;
+constexpr uint8_t KEYFRAME_CH3 = 0x04;
+constexpr uint8_t KEYFRAME_CH4 = 0x08;
+constexpr uint8_t KEYFRAME_ALL_CHANNELS = 0xFF;        // Up to 8 channels
+
+constexpr uint16_t KEYFRAME_TO_END = 0xFFFF;           // Region count: through the end of the strip
+constexpr uint32_t KEYFRAME_PRIMARY = 0xFF000000;      // Color: use the notification's color
+
+struct Keyframe {
+    uint32_t color;         // 0xRRGGBB, or KEYFRAME_PRIMARY
+    uint16_t start;         // First LED of the region
+    uint16_t count;         // Region length (KEYFRAME_TO_END = through end of strip)
+    uint16_t durationMs;    // Fade/hold time (0 = apply and move on)
+    uint8_t channelMask;    // Channels the region applies to
+    uint8_t easing;         // KeyframeEasing
+};
+
+struct KeyframePattern {
+    const Keyframe* frames;
+    uint8_t count;
 };
 
-// Notification state for all channels
+// ========== Pattern Data ==========
+
+// Solid: notification color on the first 8 LEDs (length set by request duration)
+inline constexpr Keyframe SOLID_KEYFRAMES[] = {
+    {KEYFRAME_PRIMARY, 0, 8, 1000, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+};
+
+// Sequential: one LED at a time through the first 8 LEDs, 100ms per step
+inline constexpr Keyframe SEQUENTIAL_KEYFRAMES[] = {
+    {0x000000, 0, 8, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 0, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 0, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 1, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 1, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 2, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 2, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 3, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 3, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 4, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 4, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 5, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 5, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 6, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 6, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {KEYFRAME_PRIMARY, 7, 1, 100, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x000000, 7, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+};
+
+// Warning: blue base on the first 8 LEDs, purple highlight stepping every 300ms
+// (factory reset runs 3 cycles: 3 x 8 steps x 300ms = 7.2s)
+inline constexpr Keyframe WARNING_KEYFRAMES[] = {
+    {0x0000FF, 0, 8, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 0, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 0, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 1, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 1, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 2, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 2, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 3, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 3, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 4, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 4, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 5, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 5, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 6, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 6, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+    {0x800080, 7, 1, 300, KEYFRAME_ALL_CHANNELS, EASE_STEP}, {0x0000FF, 7, 1, 0, KEYFRAME_ALL_CHANNELS, EASE_STEP},
+};
+
+// Identify: every LED on every channel breathes in and out (1s per cycle)
+inline constexpr Keyframe IDENTIFY_KEYFRAMES[] = {
+    {KEYFRAME_PRIMARY, 0, KEYFRAME_TO_END, 500, KEYFRAME_ALL_CHANNELS, EASE_IN_OUT},
+    {0x000000, 0, KEYFRAME_TO_END, 500, KEYFRAME_ALL_CHANNELS, EASE_IN_OUT},
+};
+
+// WiFi connecting: slow blue pulse on a single LED
+inline constexpr Keyframe WIFI_CONNECTING_KEYFRAMES[] = {
+    {0x0000FF, 0, 1, 750, KEYFRAME_CH1, EASE_IN_OUT},
+    {0x000000, 0, 1, 750, KEYFRAME_CH1, EASE_IN_OUT},
+};
+
+// WiFi connected: one green flash
+inline constexpr Keyframe WIFI_CONNECTED_KEYFRAMES[] = {
+    {0x00FF00, 0, 8, 400, KEYFRAME_CH1, EASE_STEP},
+    {0x000000, 0, 8, 200, KEYFRAME_CH1, EASE_LINEAR},
+};
+
+// Pairing: amber pulse on the first 8 LEDs of every channel
+inline constexpr Keyframe PAIRING_KEYFRAMES[] = {
+    {0xFF8000, 0, 8, 600, KEYFRAME_ALL_CHANNELS, EASE_IN_OUT},
+    {0x000000, 0, 8, 600, KEYFRAME_ALL_CHANNELS, EASE_IN_OUT},
+};
+
+template <uint8_t N>
+constexpr KeyframePattern makeKeyframePattern(const Keyframe (&frames)[N]) {
+    return {frames, N};
+}
+
+inline KeyframePattern getKeyframePattern(NotificationPattern pattern) {
+    switch (pattern) {
+        case PATTERN_SOLID:           return makeKeyframePattern(SOLID_KEYFRAMES);
+        case PATTERN_SEQUENTIAL:      return makeKeyframePattern(SEQUENTIAL_KEYFRAMES);
+        case PATTERN_WARNING:         return makeKeyframePattern(WARNING_KEYFRAMES);
+        case PATTERN_IDENTIFY:        return makeKeyframePattern(IDENTIFY_KEYFRAMES);
+        case PATTERN_WIFI_CONNECTING: return makeKeyframePattern(WIFI_CONNECTING_KEYFRAMES);
+        case PATTERN_WIFI_CONNECTED:  return makeKeyframePattern(WIFI_CONNECTED_KEYFRAMES);
+        case PATTERN_PAIRING:         return makeKeyframePattern(PAIRING_KEYFRAMES);
+        default:                      return {nullptr, 0};
+    }
+}
+
+// ========== Keyframe Interpreter ==========
+
+// Playback state for a single notification pattern
+// Per-frame cost is proportional to the current keyframe's region size.
+// Timing comes from the caller (shared frame clock), never from millis() or
+// delay(); time only advances while the pattern is visible.
 class NotificationState {
 public:
     NotificationState() :
-        active(false),
-        pattern(PATTERN_NONE),
-        currentStep(0),
-        lastUpdateMs(0),
-        stepDurationMs(0),
+        pattern({nullptr, 0}),
+        frameIndex(0),
+        frameElapsedMs(0),
+        lastTickMs(0),
         cycleCount(0),
         maxCycles(0) {}
 
     // Start a notification pattern
-    void start(NotificationPattern p, CRGB color, uint16_t stepDuration = 100, uint8_t cycles = 0) {
-        if (!active) {
-            // Save current LED state before starting pattern
-            saveState();
-        }
-        active = true;
-        pattern = p;
+    void start(NotificationPattern p, CRGB color, uint8_t cycles, unsigned long now) {
+        pattern = getKeyframePattern(p);
         primaryColor = color;
-        currentStep = 0;
+        frameIndex = 0;
+        frameElapsedMs = 0;
+        lastTickMs = now;
         cycleCount = 0;
         maxCycles = cycles;
-        lastUpdateMs = millis();
-        stepDurationMs = stepDuration;
     }
 
-    // Stop notification and restore previous state
-    void stop() {
-        if (active) {
-            restoreState();
-            active = false;
-            pattern = PATTERN_NONE;
+    // Redraw the pattern as of its current position without advancing
+    // Used when the pattern becomes visible (first start, or resumed after preemption)
+    // channels: numChannels LED arrays of numLeds each
+    void repaint(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds, unsigned long now) {
+        lastTickMs = now;  // Hidden time does not count
+
+        // Replay completed keyframes of this cycle, then the current one
+        for (uint8_t k = 0; k < frameIndex && k < pattern.count; k++) {
+            paintRegion(channels, numChannels, numLeds, pattern.frames[k], resolveColor(pattern.frames[k]));
         }
+        paintCurrent(channels, numChannels, numLeds);
     }
 
-    // Update animation (call from loop)
-    // Returns true if animation is still running, false if completed
-    bool update(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) {
-        if (!active) return false;
-
-        unsigned long now = millis();
-        if (now - lastUpdateMs < stepDurationMs) return true;
-
-        lastUpdateMs = now;
-
-        switch (pattern) {
-            case PATTERN_SOLID:
-                renderSolid(ch1, ch2, ch3, ch4);
-                break;
-
-            case PATTERN_SEQUENTIAL:
-                renderSequential(ch1, ch2, ch3, ch4);
-                currentStep = (currentStep + 1) % 8;
-                if (currentStep == 0 && maxCycles > 0) {
-                    cycleCount++;
-                    if (cycleCount >= maxCycles) {
-                        // Animation complete
-                        return false;
-                    }
+    // Advance the pattern (call every frame while this pattern is visible)
+    // Returns true if the pattern is still running, false if the cycle limit was reached
+    bool update(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds, unsigned long now) {
+        if (pattern.count == 0) return false;
+
+        frameElapsedMs += now - lastTickMs;
+        lastTickMs = now;
+
+        // Retire finished keyframes (bounded so all-zero-duration data cannot spin)
+        for (uint16_t guard = 0; guard <= pattern.count; guard++) {
+            const Keyframe& kf = pattern.frames[frameIndex];
+            if (frameElapsedMs < kf.durationMs) {
+                // Mid-fade: paint the interpolated color (steps were painted on entry)
+                if (kf.easing != EASE_STEP) {
+                    paintCurrent(channels, numChannels, numLeds);
                 }
-                break;
-
-            case PATTERN_WARNING:
-                renderWarning(ch1, ch2, ch3, ch4);
-                currentStep = (currentStep + 1) % 8;
-                if (currentStep == 0 && maxCycles > 0) {
-                    cycleCount++;
-                    if (cycleCount >= maxCycles) {
-                        // Animation complete
-                        return false;
-                    }
+                return true;
+            }
+
+            // Keyframe finished: settle on its final color and enter the next one
+            if (kf.easing != EASE_STEP) {
+                paintRegion(channels, numChannels, numLeds, kf, resolveColor(kf));
+            }
+            frameElapsedMs -= kf.durationMs;
+            frameIndex++;
+
+            if (frameIndex >= pattern.count) {
+                frameIndex = 0;
+                cycleCount++;
+                if (maxCycles > 0 && cycleCount >= maxCycles) {
+                    // Animation complete
+                    return false;
                 }
-                break;
+            }
 
-            default:
-                break;
+            const Keyframe& next = pattern.frames[frameIndex];
+            if (next.easing == EASE_STEP) {
+                paintRegion(channels, numChannels, numLeds, next, resolveColor(next));
+            }
         }
-
         return true;
     }
 
-    // Show confirmation pattern (solid color for duration, then restore)
-    void showConfirmation(CRGB color, uint16_t durationMs, CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4) {
-        // Show solid color
-        for (int i = 0; i < 8; i++) {
-            ch1[i] = color;
-            ch2[i] = color;
-            ch3[i] = color;
-            ch4[i] = color;
-        }
-        FastLED.show();
-        delay(durationMs);
-
-        // Restore previous state
-        restoreState();
-    }
-
-    bool isActive() const { return active; }
+    uint8_t getCycleCount() const { return cycleCount; }
+    uint8_t getMaxCycles() const { return maxCycles; }
 
 private:
-    bool active;
-    NotificationPattern pattern;
+    KeyframePattern pattern;
     CRGB primaryColor;
-    CRGB secondaryColor;
-    uint8_t currentStep;
-    unsigned long lastUpdateMs;
-    uint16_t stepDurationMs;
+    uint8_t frameIndex;             // Current keyframe
+    unsigned long frameElapsedMs;   // Visible time spent in current keyframe
+    unsigned long lastTickMs;
     uint8_t cycleCount;     // Current cycle count (for cycle-limited animations)
     uint8_t maxCycles;      // Maximum cycles (0 = unlimited)
 
-    // Storage for previous LED state (first 8 LEDs of each channel)
-    CRGB savedCh1[8];
-    CRGB savedCh2[8];
-    CRGB savedCh3[8];
-    CRGB savedCh4[8];
-
-    void saveState() {
-        // Save will happen when first pattern starts
-        // Actual saving done in start() by copying from channel arrays
+    CRGB resolveColor(const Keyframe& kf) const {
+        if (kf.color == KEYFRAME_PRIMARY) return primaryColor;
+        return CRGB((kf.color >> 16) & 0xFF, (kf.color >> 8) & 0xFF, kf.color & 0xFF);
     }
 
-    void restoreState() {
-        // Restore happens in caller context where channel arrays are accessible
+    // Color the current keyframe fades from: the previous keyframe's color
+    // (black before the very first keyframe has ever played)
+    CRGB previousColor() const {
+        if (frameIndex > 0) return resolveColor(pattern.frames[frameIndex - 1]);
+        if (cycleCount > 0) return resolveColor(pattern.frames[pattern.count - 1]);
+        return CRGB::Black;
     }
 
-    void renderSolid(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4) {
-        for (int i = 0; i < 8; i++) {
-            ch1[i] = primaryColor;
-            ch2[i] = primaryColor;
-            ch3[i] = primaryColor;
-            ch4[i] = primaryColor;
-        }
+    // Quadratic ease-in/ease-out on 0-255
+    static uint8_t easeInOut8(uint8_t x) {
+        uint16_t t = (x < 128) ? x : 255 - x;
+        uint8_t y = (uint8_t)((t * t) >> 6);  // 0..254 over the half range
+        return (x < 128) ? (y >> 1) : 255 - (y >> 1);
     }
 
-    void renderSequential(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4) {
-        // Clear all first
-        for (int i = 0; i < 8; i++) {
-            ch1[i] = CRGB::Black;
-            ch2[i] = CRGB::Black;
-            ch3[i] = CRGB::Black;
-            ch4[i] = CRGB::Black;
+    void paintCurrent(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds) {
+        const Keyframe& kf = pattern.frames[frameIndex];
+        CRGB target = resolveColor(kf);
+        if (kf.easing == EASE_STEP || kf.durationMs == 0) {
+            paintRegion(channels, numChannels, numLeds, kf, target);
+            return;
         }
 
-        // Light up current step
-        ch1[currentStep] = primaryColor;
-        ch2[currentStep] = primaryColor;
-        ch3[currentStep] = primaryColor;
-        ch4[currentStep] = primaryColor;
+        uint8_t progress = (uint8_t)((frameElapsedMs * 255) / kf.durationMs);
+        if (kf.easing == EASE_IN_OUT) progress = easeInOut8(progress);
+        paintRegion(channels, numChannels, numLeds, kf, blend(previousColor(), target, progress));
     }
 
-    void renderWarning(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4) {
-        // Base: All 8 LEDs blue
-        CRGB baseColor = CRGB::Blue;
-        CRGB highlightColor = CRGB(128, 0, 128); // Purple
-
-        for (int i = 0; i < 8; i++) {
-            CRGB color = (i == currentStep) ? highlightColor : baseColor;
-            ch1[i] = color;
-            ch2[i] = color;
-            ch3[i] = color;
-            ch4[i] = color;
-        }
-    }
+    static void paintRegion(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds, const Keyframe& kf, const CRGB& color) {
+        if (kf.start >= numLeds) return;
+        uint16_t end = (kf.count == KEYFRAME_TO_END || kf.count > numLeds - kf.start)
+                           ? numLeds : kf.start + kf.count;
 
-    // Friend class to allow access to saved state
-    friend class NotificationManager;
-};
-
-// Manager class to handle state saving/restoration
-class NotificationManager {
-public:
-    NotificationManager(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4) :
-        channel1(ch1), channel2(ch2), channel3(ch3), channel4(ch4),
-        channelService1(nullptr), channelService2(nullptr),
-        channelService3(nullptr), channelService4(nullptr) {}
-
-    // Set channel service pointers (call after channel services are created)
-    void setChannelServices(DEV_LedChannel* ch1, DEV_LedChannel* ch2, DEV_LedChannel* ch3, DEV_LedChannel* ch4) {
-        channelService1 = ch1;
-        channelService2 = ch2;
-        channelService3 = ch3;
-        channelService4 = ch4;
-    }
-
-    void start(NotificationPattern pattern, CRGB color, uint16_t stepDuration = 100, uint8_t cycles = 0) {
-        // Tell all channel services to yield to notification
-        if (channelService1) channelService1->yieldToNotification();
-        if (channelService2) channelService2->yieldToNotification();
-        if (channelService3) channelService3->yieldToNotification();
-        if (channelService4) channelService4->yieldToNotification();
-
-        // Save current state
-        for (int i = 0; i < 8; i++) {
-            state.savedCh1[i] = channel1[i];
-            state.savedCh2[i] = channel2[i];
-            state.savedCh3[i] = channel3[i];
-            state.savedCh4[i] = channel4[i];
-        }
-        state.start(pattern, color, stepDuration, cycles);
-    }
-
-    void stop() {
-        if (state.isActive()) {
-            // Restore saved state
-            for (int i = 0; i < 8; i++) {
-                channel1[i] = state.savedCh1[i];
-                channel2[i] = state.savedCh2[i];
-                channel3[i] = state.savedCh3[i];
-                channel4[i] = state.savedCh4[i];
+        for (uint8_t ch = 0; ch < numChannels; ch++) {
+            if (!(kf.channelMask & (1 << ch))) continue;
+            for (uint16_t i = kf.start; i < end; i++) {
+                channels[ch][i] = color;
             }
-            state.stop();
-
-            // Tell all channel services to resume from notification
-            if (channelService1) channelService1->resumeFromNotification();
-            if (channelService2) channelService2->resumeFromNotification();
-            if (channelService3) channelService3->resumeFromNotification();
-            if (channelService4) channelService4->resumeFromNotification();
         }
     }
-
-    bool update(uint16_t numLeds) {
-        return state.update(channel1, channel2, channel3, channel4, numLeds);
-    }
-
-    // Get cycle count (for tracking animation progress)
-    uint8_t getCycleCount() const { return state.cycleCount; }
-    uint8_t getMaxCycles() const { return state.maxCycles; }
-
-    void showConfirmation(CRGB color, uint16_t durationMs) {
-        state.showConfirmation(color, durationMs, channel1, channel2, channel3, channel4);
-    }
-
-    bool isActive() const { return state.isActive(); }
-
-private:
-    NotificationState state;
-    CRGB* channel1;
-    CRGB* channel2;
-    CRGB* channel3;
-    CRGB* channel4;
-    DEV_LedChannel* channelService1;
-    DEV_LedChannel* channelService2;
-    DEV_LedChannel* channelService3;
-    DEV_LedChannel* channelService4;
 };
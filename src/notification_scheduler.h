@@ -0,0 +1,173 @@
+#pragma once
+
+#include "notification_pattern.h"
+
+// Notification priorities (higher value preempts lower)
+enum NotificationPriority : uint8_t {
+    PRIORITY_LOW,           // Ambient status (e.g., WiFi state)
+    PRIORITY_NORMAL,        // User-requested feedback (e.g., Identify)
+    PRIORITY_HIGH,          // Pairing / setup flow
+    PRIORITY_CRITICAL       // Factory reset flow
+};
+
+// A queued notification
+struct NotificationRequest {
+    NotificationPattern pattern;
+    CRGB color;
+    uint8_t cycles;             // Complete after this many pattern cycles (0 = no cycle limit)
+    unsigned long durationMs;   // Complete after this much visible time (0 = no time limit)
+    uint8_t priority;           // NotificationPriority
+};
+
+// Non-blocking notification scheduler
+// Holds up to MAX_QUEUED notifications; the highest priority one is visible.
+// Equal priorities play in FIFO order. A higher priority arrival preempts the
+// visible notification, which keeps its progress (step, cycles, elapsed time)
+// and resumes where it left off once it is the highest priority again.
+//
+// Duration limits count visible time only, so a preempted 3s confirmation
+// still shows for a full 3s. All timing comes from the caller's frame clock.
+class NotificationScheduler {
+public:
+    static constexpr uint8_t MAX_QUEUED = 8;
+
+    NotificationScheduler() : activeSlot(NO_SLOT), lastTickMs(0), nextId(1), nextSeq(0) {
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            slots[s].id = 0;
+        }
+    }
+
+    // Queue a notification
+    // Returns a non-zero handle, or 0 if the queue is full
+    uint16_t enqueue(const NotificationRequest& request, unsigned long now) {
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id != 0) continue;
+
+            Slot& slot = slots[s];
+            slot.request = request;
+            slot.id = nextId;
+            slot.seq = nextSeq++;
+            slot.elapsedMs = 0;
+            slot.state.start(request.pattern, request.color, request.cycles, now);
+
+            nextId++;
+            if (nextId == 0) nextId = 1;  // 0 is reserved for "no handle"
+            return slot.id;
+        }
+        return 0;  // Queue full
+    }
+
+    // Remove a queued or visible notification
+    void cancel(uint16_t id) {
+        if (id == 0) return;
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id == id) {
+                slots[s].id = 0;
+                if (activeSlot == s) activeSlot = NO_SLOT;
+            }
+        }
+    }
+
+    // Remove everything
+    void clear() {
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            slots[s].id = 0;
+        }
+        activeSlot = NO_SLOT;
+    }
+
+    // Advance the visible notification and render it (call every frame)
+    // Returns true if the visible notification changed this update
+    // (preemption, resumption, or completion) - the caller should restore
+    // the underlying LED state before the new one draws on top
+    bool update(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds, unsigned long now) {
+        bool changed = false;
+
+        // Charge visible time to the current notification and retire it if done
+        if (activeSlot != NO_SLOT) {
+            Slot& slot = slots[activeSlot];
+            slot.elapsedMs += now - lastTickMs;
+
+            bool running = slot.state.update(channels, numChannels, numLeds, now);
+            if (!running || (slot.request.durationMs > 0 && slot.elapsedMs >= slot.request.durationMs)) {
+                slot.id = 0;
+                activeSlot = NO_SLOT;
+                changed = true;
+            }
+        }
+        lastTickMs = now;
+
+        // Highest priority wins (preempting or resuming as needed)
+        uint8_t best = selectHighest();
+        if (best != activeSlot) {
+            activeSlot = best;
+            changed = true;
+        }
+        return changed;
+    }
+
+    // Draw the visible notification's current step (after the caller restored LEDs)
+    void repaint(CRGB* const channels[], uint8_t numChannels, uint16_t numLeds, unsigned long now) {
+        if (activeSlot == NO_SLOT) return;
+        slots[activeSlot].state.repaint(channels, numChannels, numLeds, now);
+    }
+
+    // True while the notification is queued or visible
+    bool isPending(uint16_t id) const {
+        if (id == 0) return false;
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id == id) return true;
+        }
+        return false;
+    }
+
+    // Handle of the visible notification (0 if none)
+    uint16_t activeId() const {
+        return (activeSlot != NO_SLOT) ? slots[activeSlot].id : 0;
+    }
+
+    bool isEmpty() const {
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id != 0) return false;
+        }
+        return true;
+    }
+
+    uint8_t size() const {
+        uint8_t count = 0;
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id != 0) count++;
+        }
+        return count;
+    }
+
+private:
+    static constexpr uint8_t NO_SLOT = 0xFF;
+
+    struct Slot {
+        NotificationRequest request;
+        NotificationState state;     // Keyframe playback progress (kept across preemption)
+        uint16_t id;                 // Handle (0 = free slot)
+        uint32_t seq;                // Arrival order, for FIFO among equal priorities
+        unsigned long elapsedMs;     // Visible time so far
+    };
+
+    Slot slots[MAX_QUEUED];
+    uint8_t activeSlot;
+    unsigned long lastTickMs;
+    uint16_t nextId;
+    uint32_t nextSeq;
+
+    uint8_t selectHighest() const {
+        uint8_t best = NO_SLOT;
+        for (uint8_t s = 0; s < MAX_QUEUED; s++) {
+            if (slots[s].id == 0) continue;
+            if (best == NO_SLOT ||
+                slots[s].request.priority > slots[best].request.priority ||
+                (slots[s].request.priority == slots[best].request.priority && slots[s].seq < slots[best].seq)) {
+                best = s;
+            }
+        }
+        return best;
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "led_output.h"
+#include "../config.h"
+
+// FastLED output backend
+// One WS2811 controller per channel on PIN_LED_CHANNELS. show() is timed so
+// telemetry can compare it with the wire model (serial vs parallel channels).
+template <uint8_t CHANNELS, uint16_t LEDS>
+class FastLedOutput : public LedOutput<CHANNELS, LEDS> {
+public:
+    static_assert(CHANNELS <= sizeof(PIN_LED_CHANNELS), "One data pin per channel");
+
+    FastLedOutput() : showUs(0) {}
+
+    void begin(CRGB* const channels[CHANNELS]) override {
+        addStrips(channels);
+    }
+
+    void setBrightness(uint8_t brightness) override {
+        FastLED.setBrightness(brightness);
+    }
+
+    void show() override {
+        unsigned long start = micros();
+        FastLED.show();
+        showUs = micros() - start;
+    }
+
+    const char* getName() const override { return "FastLED"; }
+
+    uint32_t lastShowUs() const override { return showUs; }
+
+private:
+    uint32_t showUs;
+
+    // Register one controller per channel (data pins are template arguments)
+    template <uint8_t CH = 0>
+    void addStrips(CRGB* const channels[CHANNELS]) {
+        if constexpr (CH < CHANNELS) {
+            FastLED.addLeds<WS2811, PIN_LED_CHANNELS[CH], GRB>(channels[CH], LEDS);
+            addStrips<CH + 1>(channels);
+        }
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <string.h>
+
+// Temporal upsampling between simulated frames
+//
+// Animations simulate at their own (low) frame rate; the output runs at the
+// display rate. The interpolator keeps the frame on display and the newest
+// simulated frame, and every output frame shows a linear blend between them
+// that reaches the new frame as the next one is due. Output is one simulated
+// frame behind, in exchange for motion that moves every refresh.
+//
+// A frame that arrives early starts from the blend on display, so the output
+// never jumps.
+//
+// The blend works on the flat byte image of all channels. The SWAR kernel
+// blends four bytes per 32-bit word in two 16-bit-lane halves; a lane holds
+// a * (256 - w) + b * w <= 255 * 256, so nothing carries between lanes.
+//
+// Memory: 3 frames (shown, target, output) of CHANNELS x LEDS x 3 bytes.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class FrameInterpolator {
+public:
+    static_assert(sizeof(CRGB) == 3, "Frames are copied as packed RGB bytes");
+
+    static constexpr uint32_t FRAME_BYTES = (uint32_t)CHANNELS * LEDS * 3;
+    static constexpr uint32_t FRAME_WORDS = (FRAME_BYTES + 3) / 4;
+    static constexpr uint16_t FULL_WEIGHT = 256;
+
+    FrameInterpolator() : frames(0), startMs(0), durationMs(1), weight(FULL_WEIGHT) {
+        memset(shown, 0, sizeof(shown));
+        memset(target, 0, sizeof(target));
+        memset(output, 0, sizeof(output));
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            outputChannels[ch] = reinterpret_cast<CRGB*>(output + (uint32_t)ch * LEDS * 3);
+        }
+    }
+
+    // Forget the frame history (the next push shows at once)
+    void reset() { frames = 0; }
+
+    // New simulated frame (copied); it is fully shown intervalMs after nowMs
+    void push(const CRGB* const channels[CHANNELS], unsigned long nowMs, unsigned long intervalMs) {
+        if (frames == 0) {
+            copyFrame(target, channels);
+            memcpy(shown, target, sizeof(shown));
+        } else {
+            // Continue from what is on display
+            lerpWords(shown, shown, target, FRAME_WORDS, weightAt(nowMs));
+            copyFrame(target, channels);
+        }
+        frames++;
+        startMs = nowMs;
+        durationMs = intervalMs ? intervalMs : 1;
+    }
+
+    // Blend for an output frame at nowMs; false if nothing was pushed yet
+    bool render(unsigned long nowMs) {
+        if (frames == 0) return false;
+        weight = weightAt(nowMs);
+        lerpWords(output, shown, target, FRAME_WORDS, weight);
+        return true;
+    }
+
+    // Last render() reached the target frame (output stays the same until the next push)
+    bool settled() const { return weight == FULL_WEIGHT; }
+
+    // Output of the last render(), one LEDS array per channel
+    const CRGB* const* channels() const { return outputChannels; }
+
+    // Scalar kernel: out = a + (b - a) * w / 256, w in 0..256
+    static void lerpScalar(uint8_t* out, const uint8_t* a, const uint8_t* b, uint32_t count, uint16_t w) {
+        uint16_t inv = FULL_WEIGHT - w;
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = (uint8_t)((a[i] * inv + b[i] * w) >> 8);
+        }
+    }
+
+    // SWAR kernel: four bytes per word, same result as lerpScalar
+    // Buffers are 4-byte aligned and hold count words (out may alias a or b)
+    static void lerpWords(uint8_t* out, const uint8_t* a, const uint8_t* b, uint32_t count, uint16_t w) {
+        uint8_t* o = static_cast<uint8_t*>(__builtin_assume_aligned(out, 4));
+        const uint8_t* pa = static_cast<const uint8_t*>(__builtin_assume_aligned(a, 4));
+        const uint8_t* pb = static_cast<const uint8_t*>(__builtin_assume_aligned(b, 4));
+        uint32_t inv = FULL_WEIGHT - w;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t wa, wb;
+            memcpy(&wa, pa + i * 4, 4);
+            memcpy(&wb, pb + i * 4, 4);
+            uint32_t even = (((wa & 0x00FF00FF) * inv + (wb & 0x00FF00FF) * w) >> 8) & 0x00FF00FF;
+            uint32_t odd = (((wa >> 8) & 0x00FF00FF) * inv + ((wb >> 8) & 0x00FF00FF) * w) & 0xFF00FF00;
+            uint32_t result = even | odd;
+            memcpy(o + i * 4, &result, 4);
+        }
+    }
+
+private:
+    alignas(4) uint8_t shown[FRAME_WORDS * 4];      // Frame on display when the target arrived
+    alignas(4) uint8_t target[FRAME_WORDS * 4];     // Newest simulated frame
+    alignas(4) uint8_t output[FRAME_WORDS * 4];     // Last blend
+    CRGB* outputChannels[CHANNELS];
+    uint32_t frames;
+    unsigned long startMs;
+    unsigned long durationMs;
+    uint16_t weight;                                // Of the last render()
+
+    uint16_t weightAt(unsigned long nowMs) const {
+        unsigned long elapsed = nowMs - startMs;
+        if (elapsed >= durationMs) return FULL_WEIGHT;
+        return (uint16_t)(elapsed * FULL_WEIGHT / durationMs);
+    }
+
+    void copyFrame(uint8_t* dest, const CRGB* const channels[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            memcpy(dest + (uint32_t)ch * LEDS * 3, channels[ch], (uint32_t)LEDS * 3);
+        }
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// WS2811 wire-time model (800 kHz)
+//
+// Every pixel is 24 bits of 1.25 us, and a frame is latched by holding the line
+// low for the reset time. Channels on separate lanes (RMT channels, I2S lanes)
+// are clocked out at the same time; channels sharing a lane go one after another.
+namespace wire {
+    constexpr uint32_t BIT_NS = 1250;          // 800 kHz
+    constexpr uint32_t BITS_PER_PIXEL = 24;
+    constexpr uint32_t RESET_US = 280;         // WS2811 datasheet says 50 us; newer clones need 280
+
+    // Time to send one channel of leds pixels, including the latch
+    constexpr uint32_t channelUs(uint16_t leds) {
+        return (uint32_t)leds * BITS_PER_PIXEL * BIT_NS / 1000 + RESET_US;
+    }
+
+    // Time to send a frame of channels x leds over the given number of lanes
+    constexpr uint32_t frameUs(uint8_t channels, uint16_t leds, uint8_t lanes) {
+        return (uint32_t)((channels + lanes - 1) / lanes) * channelUs(leds);
+    }
+
+    // Highest frame rate the wire allows
+    constexpr uint32_t maxFps(uint32_t frameTimeUs) {
+        return frameTimeUs ? 1000000UL / frameTimeUs : 0;
+    }
+}
+
+// LED output backend
+// Pushes CHANNELS strips of LEDS pixels to the hardware. Backends differ in how
+// the channels reach the wire (one after another, or in parallel) and in how
+// long show() holds the caller.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class LedOutput {
+public:
+    virtual ~LedOutput() {}
+
+    // channels: CHANNELS LED arrays of LEDS each (read on every show())
+    virtual void begin(CRGB* const channels[CHANNELS]) = 0;
+
+    // Global brightness applied on output (0-255)
+    virtual void setBrightness(uint8_t brightness) = 0;
+
+    // Send the current LED arrays
+    virtual void show() = 0;
+
+    virtual const char* getName() const = 0;
+
+    // How long the last show() held the caller (us)
+    virtual uint32_t lastShowUs() const = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "../fixed_point.h"
+#include "../lookup_table.h"
+
+// 3x3 color-correction matrix (rows: output R, G, B; columns: input R, G, B)
+// Coefficients are Q8.8, limited to +-2.0 by the output stage
+struct ColorMatrix {
+    Q8_8 m[3][3];
+
+    static constexpr ColorMatrix identity() {
+        return whiteBalance(1.0, 1.0, 1.0);
+    }
+
+    // Per-primary gains only (e.g. tame a blue-heavy strip)
+    static constexpr ColorMatrix whiteBalance(double r, double g, double b) {
+        return ColorMatrix{{
+            {Q8_8::fromDouble(r), Q8_8::fromInt(0), Q8_8::fromInt(0)},
+            {Q8_8::fromInt(0), Q8_8::fromDouble(g), Q8_8::fromInt(0)},
+            {Q8_8::fromInt(0), Q8_8::fromInt(0), Q8_8::fromDouble(b)},
+        }};
+    }
+};
+
+// Output stage: composited frame -> values sent to the strips
+//
+// One pass per frame over every LED:
+//   1. gamma (GAMMA16: 8-bit in, 16-bit linear light out)
+//   2. per-channel color correction (white balance / crosstalk matrix)
+//   3. global brightness
+//   4. ordered temporal dithering back to 8 bits
+// Working at 16 bits until the last step keeps low brightness smooth: a value
+// that falls between two 8-bit steps alternates between them over
+// DITHER_STEPS frames (in a bit-reversed order, offset per LED so neighbours
+// are out of phase) and averages out to the exact level.
+//
+// The pass also sums R+G+B per channel after correction and before brightness,
+// which is what the power limiter needs for its estimate.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class OutputStage {
+public:
+    static constexpr uint8_t DITHER_STEPS = 8;
+
+    OutputStage() : frame(0), dithering(true) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            setCorrection(ch, ColorMatrix::identity());
+        }
+    }
+
+    void setCorrection(uint8_t ch, const ColorMatrix& matrix) {
+        diagonal[ch] = true;
+        for (uint8_t row = 0; row < 3; row++) {
+            for (uint8_t col = 0; col < 3; col++) {
+                int16_t raw = matrix.m[row][col].raw;
+                coeff[ch][row][col] = (raw > MAX_COEFF) ? MAX_COEFF : (raw < -MAX_COEFF) ? -MAX_COEFF : raw;
+                if (row != col && raw != 0) diagonal[ch] = false;
+            }
+        }
+    }
+
+    void setDithering(bool enabled) { dithering = enabled; }
+
+    // in -> out with the given global brightness (0-255, FastLED scale8 scaling)
+    // channelSums: per-channel sum of corrected R+G+B before brightness (0-255 scale)
+    // Processing the same frame again (e.g. at a lower brightness) uses the same
+    // dither phase; nextFrame() moves on once the frame is shown.
+    void process(const CRGB* const in[CHANNELS], CRGB* const out[CHANNELS], uint8_t brightness,
+                 uint32_t channelSums[CHANNELS]) {
+        uint32_t scale = (uint32_t)brightness + 1;
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            channelSums[ch] = diagonal[ch]
+                ? processChannel<false>(ch, in[ch], out[ch], scale)
+                : processChannel<true>(ch, in[ch], out[ch], scale);
+        }
+    }
+
+    // Advance the dither phase (call once per shown frame)
+    void nextFrame() { frame++; }
+
+private:
+    static constexpr int16_t MAX_COEFF = 512;      // +-2.0: keeps the 3-term sum within int32
+
+    // Dither thresholds in 1/256 of an output step, bit-reversed order, centered
+    static constexpr uint8_t DITHER[DITHER_STEPS] = {16, 144, 80, 208, 48, 176, 112, 240};
+
+    int16_t coeff[CHANNELS][3][3];
+    bool diagonal[CHANNELS];       // No crosstalk terms: skip them
+    uint8_t frame;
+    bool dithering;
+
+    template <bool FULL_MATRIX>
+    uint32_t processChannel(uint8_t ch, const CRGB* in, CRGB* out, uint32_t scale) {
+        const int16_t (*m)[3] = coeff[ch];
+        uint32_t sum = 0;
+        for (uint16_t i = 0; i < LEDS; i++) {
+            int32_t lin[3] = {GAMMA16[in[i].r], GAMMA16[in[i].g], GAMMA16[in[i].b]};
+            uint32_t threshold = dithering ? DITHER[(frame + i) & (DITHER_STEPS - 1)] : 128;
+            uint8_t result[3];
+            for (uint8_t c = 0; c < 3; c++) {
+                int32_t v = FULL_MATRIX
+                    ? (m[c][0] * lin[0] + m[c][1] * lin[1] + m[c][2] * lin[2]) >> 8
+                    : (m[c][c] * lin[c]) >> 8;
+                if (v < 0) v = 0;
+                if (v > 65535) v = 65535;
+                sum += (uint32_t)v >> 8;
+
+                uint32_t level = (((uint32_t)v * scale) >> 8) + threshold;
+                result[c] = (level > 0xFFFF) ? 255 : (uint8_t)(level >> 8);
+            }
+            out[i] = CRGB(result[0], result[1], result[2]);
+        }
+        return sum;
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "esp32-hal-rmt.h"
+#include "led_output.h"
+#include "wire_framebuffer.h"
+#include "../config.h"
+
+// Parallel RMT output backend
+// Every channel gets its own RMT transmitter, and show() starts them all with
+// rmtWriteAsync(), so a frame takes one channel's wire time instead of the sum
+// over channels. show() only waits if the previous frame is still on the wire,
+// then encodes the LED arrays into the wire framebuffer (table-driven; GRB
+// order and global brightness fused in) and hands its buffers to the driver.
+//
+// The framebuffer must stay untouched while a frame is in flight, hence the
+// wait before encoding.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class ParallelRmtOutput : public LedOutput<CHANNELS, LEDS> {
+public:
+    static_assert(CHANNELS <= sizeof(PIN_LED_CHANNELS), "One data pin per channel");
+    static_assert(CHANNELS <= 8, "ESP32 has 8 RMT channels");
+    static_assert(sizeof(rmt_data_t) == sizeof(wire::Symbol), "Wire symbols must match rmt_data_t");
+
+    ParallelRmtOutput() : inFlight(false), showUs(0) {}
+
+    void begin(CRGB* const channels[CHANNELS]) override {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            this->channels[ch] = channels[ch];
+            if (!rmtInit(PIN_LED_CHANNELS[ch], RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, wire::TICK_HZ)) {
+                Serial.printf("RMT init failed on GPIO%d\n", PIN_LED_CHANNELS[ch]);
+            }
+        }
+    }
+
+    void setBrightness(uint8_t brightness) override {
+        framebuffer.setBrightness(brightness);
+    }
+
+    void show() override {
+        unsigned long start = micros();
+
+        // Previous frame must leave the wire before its buffers are reused
+        waitForFrame();
+
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            framebuffer.setChannel(ch, channels[ch]);
+        }
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            rmtWriteAsync(PIN_LED_CHANNELS[ch], reinterpret_cast<rmt_data_t*>(framebuffer.channel(ch)),
+                          Framebuffer::SYMBOLS_PER_CHANNEL);
+        }
+        inFlight = true;
+
+        showUs = micros() - start;
+    }
+
+    const char* getName() const override { return "Parallel RMT"; }
+
+    uint32_t lastShowUs() const override { return showUs; }
+
+private:
+    typedef WireFramebuffer<CHANNELS, LEDS> Framebuffer;
+
+    CRGB* channels[CHANNELS];
+    Framebuffer framebuffer;
+    bool inFlight;
+    uint32_t showUs;
+
+    void waitForFrame() {
+        if (!inFlight) return;
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            while (!rmtTransmitCompleted(PIN_LED_CHANNELS[ch])) {
+                yield();
+            }
+        }
+        inFlight = false;
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "led_output.h"
+
+// Simulated output backend (native tests and capacity planning)
+// Models the wire instead of driving it: channels are spread over LANES
+// parallel lanes and a frame occupies the wire for wire::frameUs(). show()
+// first waits for the previous frame to leave the wire; a blocking backend
+// also waits for its own frame, an async (DMA/RMT) one returns at once.
+//
+// Time comes from an injected microsecond clock, like TaskScheduler.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class SimulatedOutput : public LedOutput<CHANNELS, LEDS> {
+public:
+    typedef unsigned long (*ClockFn)();
+
+    SimulatedOutput(ClockFn clockUs, uint8_t lanes, bool async) :
+        clock(clockUs),
+        lanes(lanes ? lanes : 1),
+        async(async),
+        brightness(255),
+        busyUntilUs(0),
+        showUs(0),
+        frames(0),
+        totalShowUs(0) {}
+
+    void begin(CRGB* const channels[CHANNELS]) override { (void)channels; }
+
+    void setBrightness(uint8_t brightness) override { this->brightness = brightness; }
+
+    void show() override {
+        unsigned long now = clock();
+        unsigned long start = (busyUntilUs > now) ? busyUntilUs : now;
+        busyUntilUs = start + frameTimeUs();
+
+        showUs = (async ? start : busyUntilUs) - now;
+        totalShowUs += showUs;
+        frames++;
+    }
+
+    const char* getName() const override { return "Simulated"; }
+
+    uint32_t lastShowUs() const override { return showUs; }
+
+    // Wire time of one frame for this topology
+    uint32_t frameTimeUs() const { return wire::frameUs(CHANNELS, LEDS, lanes); }
+
+    // Highest frame rate this topology can sustain
+    uint32_t maxFps() const { return wire::maxFps(frameTimeUs()); }
+
+    uint32_t frameCount() const { return frames; }
+
+    // Total time show() held the caller
+    uint32_t totalBlockedUs() const { return totalShowUs; }
+
+    uint8_t getBrightness() const { return brightness; }
+
+private:
+    ClockFn clock;
+    uint8_t lanes;
+    bool async;
+    uint8_t brightness;
+    unsigned long busyUntilUs;  // Wire busy with the last frame until then
+    uint32_t showUs;
+    uint32_t frames;
+    uint32_t totalShowUs;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "led_output.h"
+#include "../lookup_table.h"
+
+// WS2811 pulse symbols at the RMT tick rate
+// A symbol is one bit on the wire: high for duration0 ticks, then low for
+// duration1 ticks. The word layout matches the ESP32 rmt_data_t union
+// (duration0:15, level0:1, duration1:15, level1:1), so an encoded buffer can be
+// handed to the RMT driver as is.
+namespace wire {
+    constexpr uint32_t TICK_HZ = 20000000;     // 50 ns ticks, 25 per 1.25 us bit
+    constexpr uint16_t T0H = 8;                // 0.40 us
+    constexpr uint16_t T0L = 17;               // 0.85 us
+    constexpr uint16_t T1H = 16;               // 0.80 us
+    constexpr uint16_t T1L = 9;                // 0.45 us
+    constexpr uint16_t RESET_TICKS = RESET_US * (TICK_HZ / 1000000) / 2;   // Each half of the latch symbol
+
+    typedef uint32_t Symbol;
+
+    constexpr Symbol makeSymbol(uint16_t level0, uint16_t duration0, uint16_t level1, uint16_t duration1) {
+        return (Symbol)duration0 | ((Symbol)level0 << 15) | ((Symbol)duration1 << 16) | ((Symbol)level1 << 31);
+    }
+
+    constexpr Symbol ZERO = makeSymbol(1, T0H, 0, T0L);
+    constexpr Symbol ONE = makeSymbol(1, T1H, 0, T1L);
+    constexpr Symbol LATCH = makeSymbol(0, RESET_TICKS, 0, RESET_TICKS);
+
+    // One byte on the wire: 8 symbols, MSB first
+    struct ByteSymbols {
+        Symbol bits[8];
+    };
+
+    // Byte -> symbols for every byte value (8 KB, flash)
+    inline constexpr Lut<ByteSymbols, 256> BYTE_SYMBOLS = makeLut<ByteSymbols, 256>([](size_t value) {
+        ByteSymbols out{};
+        for (int bit = 0; bit < 8; bit++) {
+            out.bits[bit] = (value & (0x80 >> bit)) ? ONE : ZERO;
+        }
+        return out;
+    });
+}
+
+// Frame already encoded in the wire format
+//
+// Pixels are written straight into RMT symbols: global brightness, GRB byte
+// order and bit expansion happen in one step (a brightness table lookup, then
+// one 8-symbol table copy per color byte). The buffer of each channel ends
+// with the latch, so transmitting a frame is a pointer handoff to the driver.
+//
+// Memory: CHANNELS x (LEDS x 24 + 1) x 4 bytes.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class WireFramebuffer {
+public:
+    static constexpr uint32_t SYMBOLS_PER_PIXEL = wire::BITS_PER_PIXEL;
+    static constexpr uint32_t SYMBOLS_PER_CHANNEL = (uint32_t)LEDS * SYMBOLS_PER_PIXEL + 1;
+
+    WireFramebuffer() : brightness(0) {
+        for (int v = 0; v < 256; v++) {
+            scaled[v] = 0;
+        }
+        setBrightness(255);
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            for (uint32_t i = 0; i < SYMBOLS_PER_CHANNEL - 1; i++) {
+                symbols[ch][i] = wire::ZERO;
+            }
+            symbols[ch][SYMBOLS_PER_CHANNEL - 1] = wire::LATCH;
+        }
+    }
+
+    // Global brightness folded into the encoding (same scaling as FastLED's scale8)
+    void setBrightness(uint8_t brightness) {
+        if (brightness == this->brightness) return;
+        this->brightness = brightness;
+        for (int v = 0; v < 256; v++) {
+            scaled[v] = scale8(v, brightness);
+        }
+    }
+
+    // Encode one pixel in place
+    void setPixel(uint8_t ch, uint16_t index, const CRGB& color) {
+        wire::Symbol* out = &symbols[ch][index * SYMBOLS_PER_PIXEL];
+        out = putByte(out, scaled[color.g]);
+        out = putByte(out, scaled[color.r]);
+        putByte(out, scaled[color.b]);
+    }
+
+    // Encode a whole strip
+    void setChannel(uint8_t ch, const CRGB* leds) {
+        for (uint16_t i = 0; i < LEDS; i++) {
+            setPixel(ch, i, leds[i]);
+        }
+    }
+
+    // Encoded channel, ready to transmit (SYMBOLS_PER_CHANNEL symbols)
+    const wire::Symbol* channel(uint8_t ch) const { return symbols[ch]; }
+    wire::Symbol* channel(uint8_t ch) { return symbols[ch]; }
+
+private:
+    wire::Symbol symbols[CHANNELS][SYMBOLS_PER_CHANNEL];
+    uint8_t brightness;
+    uint8_t scaled[256];        // Value after global brightness
+
+    static wire::Symbol* putByte(wire::Symbol* out, uint8_t value) {
+        const wire::Symbol* bits = wire::BYTE_SYMBOLS[value].bits;
+        for (uint8_t b = 0; b < 8; b++) {
+            out[b] = bits[b];
+        }
+        return out + 8;
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Power-budget estimator and current limiter
+//
+// Estimates strip current from the frame about to be shown and picks the
+// highest global output brightness that keeps the total within the PSU budget.
+//
+// Model: every LED draws an idle current, plus maPerColor for each of its R, G
+// and B outputs at full value, scaled linearly by value and by the output
+// brightness. The estimate only needs the per-channel sum of R+G+B. The
+// output stage produces it while processing each frame (after gamma and color
+// correction, before brightness), so every frame shown is estimated, whoever
+// wrote it (animations, HomeKit colors, notifications).
+//
+// Smoothing: the brightness drops at once when the frame would exceed the
+// budget (the PSU must be protected on the first frame), but recovers by at
+// most RELEASE_STEP per frame, so content flickering around the limit does not
+// make the whole installation pump.
+template <uint8_t CHANNELS, uint16_t LEDS>
+class PowerLimiter {
+public:
+    static constexpr uint8_t RELEASE_STEP = 2;      // Brightness recovery per frame (full range in ~2.5 s at 50 Hz)
+
+    PowerLimiter(uint32_t budgetMa, uint16_t maPerColor, uint16_t idleUaPerLed) :
+        budgetMa(budgetMa),
+        maPerColor(maPerColor),
+        idleMaPerChannel((uint32_t)LEDS * idleUaPerLed / 1000),
+        applied(255) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            sums[ch] = 0;
+        }
+    }
+
+    // Frame sums of R+G+B per channel (from OutputStage::process)
+    void setChannelSums(const uint32_t channelSums[CHANNELS]) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            sums[ch] = channelSums[ch];
+        }
+    }
+
+    // Brightness to output this frame for a requested brightness (call once per frame)
+    uint8_t limit(uint8_t requested) {
+        uint8_t target = requested;
+        uint32_t colorMa = totalColorMa();
+        uint32_t idleMa = idleMaPerChannel * CHANNELS;
+        if (colorMa > 0 && idleMa + scaleMa(colorMa, requested) > budgetMa) {
+            // Largest b with idle + color * (b + 1) / 256 <= budget
+            uint32_t room = (budgetMa > idleMa) ? budgetMa - idleMa : 0;
+            uint32_t b = room * 256 / colorMa;
+            target = (b == 0) ? 0 : (uint8_t)(b - 1);
+        }
+
+        if (target <= applied) {
+            applied = target;
+        } else {
+            applied = (target - applied > RELEASE_STEP) ? applied + RELEASE_STEP : target;
+        }
+        return applied;
+    }
+
+    // Brightness chosen by the last limit()
+    uint8_t brightness() const { return applied; }
+
+    // Estimated current of one channel at a brightness (mA)
+    uint32_t channelMa(uint8_t ch, uint8_t brightness) const {
+        return idleMaPerChannel + scaleMa(colorMaOf(ch), brightness);
+    }
+
+    // Estimated total at a brightness (mA)
+    uint32_t estimatedMa(uint8_t brightness) const {
+        return idleMaPerChannel * CHANNELS + scaleMa(totalColorMa(), brightness);
+    }
+
+    // Estimated total at the applied brightness (mA)
+    uint32_t limitedMa() const { return estimatedMa(applied); }
+
+    uint32_t getBudgetMa() const { return budgetMa; }
+
+private:
+    uint32_t budgetMa;
+    uint16_t maPerColor;
+    uint32_t idleMaPerChannel;
+    uint8_t applied;                // Smoothed output brightness
+    uint32_t sums[CHANNELS];        // Sum of R+G+B over the channel
+
+    uint32_t colorMaOf(uint8_t ch) const {
+        return sums[ch] * maPerColor / 255;
+    }
+
+    uint32_t totalColorMa() const {
+        uint32_t total = 0;
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            total += colorMaOf(ch);
+        }
+        return total;
+    }
+
+    // Same scaling as the output (scale8: (brightness + 1) / 256)
+    static uint32_t scaleMa(uint32_t ma, uint8_t brightness) {
+        return ma * (brightness + 1) / 256;
+    }
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Cooperative deadline scheduler for loop()
+// Subsystems register a callback with a period; runDue() runs every task whose
+// deadline has passed (earliest deadline first), and idleTime() says how long
+// loop() may sleep before the next one is due. Tasks can also move their own
+// next deadline (setNextDeadline) or ask to run as soon as possible (wake).
+//
+// Time comes from an injected clock function (millis() on the device, a
+// simulated clock in native tests), re-read around each task so lateness and
+// busy time are measured, not assumed.
+//
+// Statistics: per-task run count and worst lateness (start - deadline), plus
+// busy/idle totals for the idle percentage.
+class TaskScheduler {
+public:
+    typedef void (*TaskFn)();
+    typedef unsigned long (*ClockFn)();
+
+    static constexpr uint8_t MAX_TASKS = 8;
+    static constexpr int8_t INVALID_TASK = -1;
+
+    struct TaskStats {
+        uint32_t runs;
+        unsigned long maxLatenessMs;    // Worst (start time - deadline)
+    };
+
+    explicit TaskScheduler(ClockFn clockFn) :
+        clock(clockFn), numTasks(0), busyMs(0), idleMs(0) {}
+
+    // Register a periodic task (first run is due immediately)
+    // Returns the task id, or INVALID_TASK if the table is full
+    int8_t addTask(const char* name, TaskFn fn, unsigned long periodMs) {
+        if (numTasks >= MAX_TASKS) return INVALID_TASK;
+
+        Task& task = tasks[numTasks];
+        task.name = name;
+        task.fn = fn;
+        task.periodMs = periodMs;
+        task.deadline = clock();
+        task.stats = {0, 0};
+        task.deadlineOverridden = false;
+        task.ranThisPass = false;
+        return numTasks++;
+    }
+
+    // Override a task's next deadline (e.g., a task that knows when it is next needed)
+    void setNextDeadline(int8_t id, unsigned long deadline) {
+        if (id < 0 || id >= numTasks) return;
+        tasks[id].deadline = deadline;
+        tasks[id].deadlineOverridden = true;
+    }
+
+    // Make a task due now
+    void wake(int8_t id) {
+        setNextDeadline(id, clock());
+    }
+
+    // Run every task whose deadline has passed, earliest deadline first
+    // Returns the number of tasks run
+    uint8_t runDue() {
+        uint8_t ran = 0;
+
+        // Each pass picks the most overdue task, so a slow task cannot starve the rest;
+        // bounded to one run per task per call
+        for (uint8_t pass = 0; pass < numTasks; pass++) {
+            unsigned long now = clock();
+            int8_t next = earliestDue(now);
+            if (next == INVALID_TASK) break;
+
+            Task& task = tasks[next];
+            unsigned long lateness = now - task.deadline;
+            if (lateness > task.stats.maxLatenessMs) task.stats.maxLatenessMs = lateness;
+
+            task.deadlineOverridden = false;
+            task.ranThisPass = true;
+            task.fn();
+
+            unsigned long end = clock();
+            busyMs += end - now;
+            task.stats.runs++;
+
+            // Next deadline: keep the period phase, but skip missed slots rather than bursting
+            if (!task.deadlineOverridden) {
+                task.deadline += task.periodMs;
+                if ((long)(end - task.deadline) > 0) {
+                    task.deadline = end + task.periodMs;
+                }
+            }
+            ran++;
+        }
+
+        for (uint8_t t = 0; t < numTasks; t++) {
+            tasks[t].ranThisPass = false;
+        }
+        return ran;
+    }
+
+    // Milliseconds until the earliest deadline (0 if something is already due)
+    unsigned long idleTime() const {
+        if (numTasks == 0) return 0;
+
+        unsigned long now = clock();
+        long earliest = (long)(tasks[0].deadline - now);
+        for (uint8_t t = 1; t < numTasks; t++) {
+            long remaining = (long)(tasks[t].deadline - now);
+            if (remaining < earliest) earliest = remaining;
+        }
+        return earliest > 0 ? (unsigned long)earliest : 0;
+    }
+
+    // Account time spent sleeping (call after sleeping for idleTime())
+    void noteIdle(unsigned long ms) { idleMs += ms; }
+
+    // Percentage of accounted time spent idle (0-100)
+    uint8_t idlePercent() const {
+        unsigned long total = busyMs + idleMs;
+        return total ? (uint8_t)((idleMs * 100) / total) : 0;
+    }
+
+    const TaskStats& getStats(int8_t id) const { return tasks[id].stats; }
+    const char* getName(int8_t id) const { return tasks[id].name; }
+    uint8_t getNumTasks() const { return numTasks; }
+
+    void resetStats() {
+        busyMs = 0;
+        idleMs = 0;
+        for (uint8_t t = 0; t < numTasks; t++) {
+            tasks[t].stats = {0, 0};
+        }
+    }
+
+private:
+    struct Task {
+        const char* name;
+        TaskFn fn;
+        unsigned long periodMs;
+        unsigned long deadline;
+        TaskStats stats;
+        bool deadlineOverridden;    // Task set its own next deadline while running
+        bool ranThisPass;           // Already run in the current runDue() call
+    };
+
+    ClockFn clock;
+    Task tasks[MAX_TASKS];
+    uint8_t numTasks;
+    unsigned long busyMs;
+    unsigned long idleMs;
+
+    int8_t earliestDue(unsigned long now) const {
+        int8_t best = INVALID_TASK;
+        for (uint8_t t = 0; t < numTasks; t++) {
+            if (tasks[t].ranThisPass) continue;
+            if ((long)(now - tasks[t].deadline) < 0) continue;  // Not due yet
+            if (best == INVALID_TASK || (long)(tasks[t].deadline - tasks[best].deadline) < 0) {
+                best = t;
+            }
+        }
+        return best;
+    }
+};
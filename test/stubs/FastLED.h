@@ -60,6 +60,16 @@ struct CHSV {
     }
 };
 
+// Scale a value by (scale+1)/256 (FastLED's fixed-scaling scale8)
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+    return ((uint16_t)i * (1 + scale)) >> 8;
+}
+
+// Scale a value by scale/256, never scaling a non-zero value to zero
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+    return ((i * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
 // Blend two CRGB colors
 inline CRGB blend(const CRGB& a, const CRGB& b, uint8_t amount) {
     uint8_t invAmount = 255 - amount;
@@ -1,14 +1,49 @@
 #include <unity.h>
 #include "../../src/animation/animation_base.h"
+#include "../../src/notification_scheduler.h"
+#include "../../src/button_input.h"
+#include "../../src/task_scheduler.h"
+#include "../../src/led_canvas.h"
+#include "../../src/animation/frame_slicer.h"
+#include "../../src/animation/quality_governor.h"
+#include "../../src/animation/particle_pool.h"
+#include "../../src/animation/noise_base_layer.h"
+#include "../../src/output/simulated_output.h"
+#include "../../src/output/wire_framebuffer.h"
+#include "../../src/power_limiter.h"
+#include "../../src/output/output_stage.h"
+#include "../../src/output/frame_interpolator.h"
+#include "../../src/animation/rain/triadic_rain.h"
+#include "../../src/animation/runner/monochromatic_runner.h"
+#include "../../src/lookup_table.h"
+#include "../../src/fixed_point.h"
+#include "../../src/animation/twinkle/twinkle_field.h"
+#include "../../src/animation/twinkle/monochromatic_twinkle.h"
+#include "../../src/animation/twinkle/triadic_twinkle.h"
+#include <math.h>
+#include <chrono>
+
+// Benchmark helper: average wall-clock microseconds per call of fn()
+template <typename Fn>
+double benchmarkUs(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Hardware layout for animation tests (matches the default build: 4 x 200)
+const uint8_t TEST_CHANNELS = 4;
+const uint16_t TEST_LEDS = 200;
 
 // Test helper: Create a concrete animation class for testing
-class TestAnimation : public AnimationBase {
+class TestAnimation : public AnimationBase<TEST_CHANNELS, TEST_LEDS> {
 public:
     void begin() override {}
     bool update(unsigned long deltaMs) override { (void)deltaMs; return false; }
-    void render(CRGB* ch1, CRGB* ch2, CRGB* ch3, CRGB* ch4, uint16_t numLeds) override {
-        (void)ch1; (void)ch2; (void)ch3; (void)ch4; (void)numLeds;
-    }
+    void render(CRGB* const channels[TEST_CHANNELS]) override { (void)channels; }
     void reset() override {}
     const char* getName() const override { return "Test"; }
 
@@ -123,19 +158,2344 @@ void test_generate_spread_bounded() {
     }
 }
 
-int main() {
-    UNITY_BEGIN();
+// ========== Harmony Tests ==========
 
-    // Markov transition tests
-    RUN_TEST(test_markov_transition_returns_valid_values);
-    RUN_TEST(test_markov_transition_momentum_positive);
-    RUN_TEST(test_markov_transition_momentum_negative);
-    RUN_TEST(test_markov_transition_neutral_distribution);
-    RUN_TEST(test_markov_brightness_biased_upward_trend);
+// Triadic Rain with its internals exposed for testing (harmony pick, palettes,
+// base layer, raindrops)
+class TriadicRainProbe : public TriadicRain<TEST_CHANNELS, TEST_LEDS> {
+public:
+    typedef TriadicRain<TEST_CHANNELS, TEST_LEDS> Rain;
+    using Rain::raindrops;
+    using Rain::covered;
+    using Rain::checkCollision;
 
-    // Generate spread tests
-    RUN_TEST(test_generate_spread_centered);
-    RUN_TEST(test_generate_spread_bounded);
+    uint8_t pick() { return pickHarmonyColor(HARMONY_OFFSETS); }
+    const Palette& getPalette(int ch) const { return palette[ch]; }
+
+    uint32_t baseChecksum() const {
+        uint32_t sum = 0;
+        for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+            for (int i = 0; i < TEST_LEDS; i++) {
+                sum = sum * 31 + baseBrightness[ch][i] * 7 + (uint8_t)hueOffset[ch][i];
+            }
+        }
+        return sum;
+    }
+};
+
+// Monochromatic Runner with its internals exposed for testing (harmony pick,
+// palettes, runners) and a settable frame interval
+class MonochromaticRunnerProbe : public MonochromaticRunner<TEST_CHANNELS, TEST_LEDS> {
+public:
+    typedef MonochromaticRunner<TEST_CHANNELS, TEST_LEDS> Runner;
+    using Runner::runners;
+    using Runner::gaussianLUT;
+    unsigned long intervalMs = RUNNER_FRAME_MS;
+
+    unsigned long frameIntervalMs() const override { return intervalMs; }
+
+    uint8_t pick() { return pickHarmonyColor(HARMONY_OFFSETS); }
+    const Palette& getPalette(int ch) const { return palette[ch]; }
+
+    // Only one runner on channel 0 (slot 0), head at a raw Q16.16 position
+    void place(int32_t headRaw) {
+        reset();
+        int8_t r = runners[0].allocate();
+        runners[0].pos[r] = Q16_16::fromRaw(headRaw);
+        runners[0].velocity[r] = Q8_8::fromInt(0);
+        runners[0].color[r] = 0;
+        markRunner(0, runners[0].pos[r].toInt());
+    }
+};
+
+class TriadicTwinkleProbe : public TriadicTwinkle<TEST_CHANNELS, TEST_LEDS> {
+public:
+    uint8_t color(int ch, int i) const { return ledColor[ch][i]; }
+};
+
+typedef HarmonyPalette<10> TestPalette;  // ANGLE_WIDTH = 10 (±5°)
+
+void test_harmony_pick_uses_leaf_offsets() {
+    static TriadicRainProbe anim;
+    int hits[3] = {0, 0, 0};
+
+    for (int i = 0; i < 600; i++) {
+        uint8_t index = anim.pick();
+
+        // Index must address one of the three harmony slots within the ±5° spread
+        int slot = index / TestPalette::SPREAD_STEPS - 1;
+        int spread = index % TestPalette::SPREAD_STEPS - 5;
+        TEST_ASSERT_TRUE(slot >= 0 && slot < 3);
+        TEST_ASSERT_TRUE(spread >= -5 && spread <= 5);
+        hits[slot]++;
+    }
+
+    TEST_ASSERT_INT_WITHIN(80, 200, hits[0]);
+    TEST_ASSERT_INT_WITHIN(80, 200, hits[1]);
+    TEST_ASSERT_INT_WITHIN(80, 200, hits[2]);
+}
+
+void test_harmony_pick_monochromatic_is_primary() {
+    static MonochromaticRunnerProbe anim;
+    const int hues[] = {180, 180, 180, 180};
+    anim.setChannelHues(hues);
+
+    for (int i = 0; i < 100; i++) {
+        // Primary hue is desaturated to white
+        const CRGB& c = anim.getPalette(2).entry(anim.pick());
+        TEST_ASSERT_EQUAL(255, c.r);
+        TEST_ASSERT_EQUAL(255, c.g);
+        TEST_ASSERT_EQUAL(255, c.b);
+    }
+}
+
+void test_harmony_palette_matches_hsv() {
+    static TriadicRainProbe anim;
+    const int hues[] = {0, 90, 200, 300};
+    anim.setChannelHues(hues);
+    const TestPalette& pal = anim.getPalette(1);   // Channel hue 90°
+
+    // Base slot: channel hue at full saturation, with spread
+    for (int spread = -5; spread <= 5; spread++) {
+        CRGB expected = CHSV(map(90 + spread, 0, 360, 0, 255), 255, 255);
+        const CRGB& actual = pal.entry(TestPalette::baseIndex(spread));
+        TEST_ASSERT_EQUAL(expected.r, actual.r);
+        TEST_ASSERT_EQUAL(expected.g, actual.g);
+        TEST_ASSERT_EQUAL(expected.b, actual.b);
+    }
+
+    // Harmony slot 2 (240° offset, wraps to 330°), scaled like CHSV value
+    CRGB expected = CHSV(map(330, 0, 360, 0, 255), 255, 128);
+    CRGB actual = pal.color(TestPalette::harmonyIndex(2, 0), 128);
+    TEST_ASSERT_INT_WITHIN(2, expected.r, actual.r);
+    TEST_ASSERT_INT_WITHIN(2, expected.g, actual.g);
+    TEST_ASSERT_INT_WITHIN(2, expected.b, actual.b);
+}
+
+void test_harmony_twinkle_brightness_moves_only_delta_leds() {
+    std::srand(21);
+    static TriadicTwinkleProbe anim;
+    static uint8_t before[200];
+    anim.begin();  // Brightness 100: 190 primary, 5 + 5 secondary
+
+    for (int i = 0; i < 200; i++) before[i] = anim.color(0, i);
+
+    // Brightness 49 -> 98 primary, 51 + 51 secondary
+    const int dimmed[] = {49, 100, 100, 100};
+    anim.setChannelBrightnesses(dimmed);
+    int counts[3] = {0, 0, 0};
+    int changed = 0;
+    for (int i = 0; i < 200; i++) {
+        uint8_t c = anim.color(0, i);
+        counts[c / TestPalette::SPREAD_STEPS - 1]++;
+        if (c != before[i]) {
+            changed++;
+            // Moved LEDs leave primary and keep their spread
+            TEST_ASSERT_EQUAL(0, before[i] / TestPalette::SPREAD_STEPS - 1);
+            TEST_ASSERT_EQUAL(before[i] % TestPalette::SPREAD_STEPS, c % TestPalette::SPREAD_STEPS);
+        }
+    }
+    TEST_ASSERT_EQUAL(98, counts[0]);
+    TEST_ASSERT_EQUAL(51, counts[1]);
+    TEST_ASSERT_EQUAL(51, counts[2]);
+    TEST_ASSERT_EQUAL(190 - 98, changed);
+
+    // Going back restores the original scene exactly
+    const int full[] = {100, 100, 100, 100};
+    anim.setChannelBrightnesses(full);
+    for (int i = 0; i < 200; i++) TEST_ASSERT_EQUAL(before[i], anim.color(0, i));
+
+    // A hue change only rebuilds the palette
+    const int hues[] = {200, 0, 0, 0};
+    anim.setChannelHues(hues);
+    for (int i = 0; i < 200; i++) TEST_ASSERT_EQUAL(before[i], anim.color(0, i));
+}
+
+// ========== Channel Layout Tests ==========
+
+// Render every animation family on an 8 x 600 layout: all strips fully written
+template <typename Anim>
+static void checkLayout8x600() {
+    static Anim anim;
+    static CRGB leds[8][600];
+    CRGB* strips[8];
+    int hues[8];
+    for (int ch = 0; ch < 8; ch++) {
+        strips[ch] = leds[ch];
+        hues[ch] = ch * 45;
+        for (int i = 0; i < 600; i++) leds[ch][i] = CRGB(1, 2, 3);
+    }
+    anim.setChannelHues(hues);
+    anim.begin();
+    anim.update(50);
+    anim.render(strips);
+
+    for (int ch = 0; ch < 8; ch++) {
+        for (int i = 0; i < 600; i++) {
+            TEST_ASSERT_FALSE(leds[ch][i].r == 1 && leds[ch][i].g == 2 && leds[ch][i].b == 3);
+        }
+    }
+}
+
+void test_layout_8x600_renders_every_strip() {
+    checkLayout8x600<TriadicRain<8, 600>>();
+    checkLayout8x600<MonochromaticRunner<8, 600>>();
+    checkLayout8x600<TriadicTwinkle<8, 600>>();
+    checkLayout8x600<MonochromaticTwinkle<8, 600>>();
+}
+
+void test_layout_state_scales_with_hardware() {
+    // Per-LED state is sized by the template parameters, not a fixed maximum
+    TEST_ASSERT_TRUE(sizeof(TriadicRain<1, 50>) < sizeof(TriadicRain<4, 200>));
+    TEST_ASSERT_TRUE(sizeof(TriadicRain<8, 600>) >= 8 * 600 * 4);
+    TEST_ASSERT_TRUE(sizeof(TriadicTwinkle<1, 50>) < sizeof(TriadicTwinkle<4, 200>) / 8);
+}
+
+// ========== Canvas Layout Tests ==========
+
+// Tag each canvas pixel with its flat index
+template <typename Canvas>
+static void fillCanvasIndices(Canvas& canvas, uint8_t segments, uint16_t segmentLeds) {
+    for (uint8_t s = 0; s < segments; s++) {
+        for (uint16_t i = 0; i < segmentLeds; i++) {
+            uint16_t k = s * segmentLeds + i;
+            canvas.segments()[s][i] = CRGB(k & 0xFF, k >> 8, 7);
+        }
+    }
+}
+
+static int canvasIndexAt(const CRGB& led) {
+    return (led.b == 7) ? (led.r | (led.g << 8)) : -1;
+}
+
+void test_canvas_default_layout_is_identity() {
+    static LedCanvas<4, 200, 4, 200> canvas;
+    static CRGB leds[4][200];
+    CRGB* strips[4] = {leds[0], leds[1], leds[2], leds[3]};
+
+    fillCanvasIndices(canvas, 4, 200);
+    canvas.gather(strips);
+    for (int ch = 0; ch < 4; ch++) {
+        TEST_ASSERT_EQUAL(ch, canvas.ownerChannel(ch));
+        for (int i = 0; i < 200; i++) {
+            TEST_ASSERT_EQUAL(ch * 200 + i, canvasIndexAt(leds[ch][i]));
+        }
+    }
+}
+
+void test_canvas_segment_spans_channels() {
+    // One 800-pixel run snaking over four strips (odd strips fed from the far end)
+    static LedCanvas<1, 800, 4, 200> canvas;
+    static CRGB leds[4][200];
+    CRGB* strips[4] = {leds[0], leds[1], leds[2], leds[3]};
+    const SegmentRun layout[] = {
+        {0, 0, 0, 0, 200, false},
+        {0, 200, 1, 199, 200, true},
+        {0, 400, 2, 0, 200, false},
+        {0, 600, 3, 199, 200, true},
+    };
+    TEST_ASSERT_TRUE(canvas.setLayout(layout));
+
+    fillCanvasIndices(canvas, 1, 800);
+    canvas.gather(strips);
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_EQUAL(i, canvasIndexAt(leds[0][i]));
+        TEST_ASSERT_EQUAL(399 - i, canvasIndexAt(leds[1][i]));
+        TEST_ASSERT_EQUAL(400 + i, canvasIndexAt(leds[2][i]));
+        TEST_ASSERT_EQUAL(799 - i, canvasIndexAt(leds[3][i]));
+    }
+    TEST_ASSERT_EQUAL(0, canvas.ownerChannel(0));
+}
+
+void test_canvas_zones_leave_unmapped_leds_black() {
+    // Channel 1 split into two zones, channel 2 shows one zone, channels 3-4 unused
+    static LedCanvas<3, 100, 4, 200> canvas;
+    static CRGB leds[4][200];
+    CRGB* strips[4] = {leds[0], leds[1], leds[2], leds[3]};
+    const SegmentRun layout[] = {
+        {0, 0, 0, 0, 100, false},
+        {1, 0, 0, 100, 100, false},
+        {2, 0, 1, 50, 100, false},
+    };
+    TEST_ASSERT_TRUE(canvas.setLayout(layout));
+    TEST_ASSERT_EQUAL(0, canvas.ownerChannel(1));
+    TEST_ASSERT_EQUAL(1, canvas.ownerChannel(2));
+
+    fillCanvasIndices(canvas, 3, 100);
+    canvas.gather(strips);
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_EQUAL(i, canvasIndexAt(leds[0][i]));
+        TEST_ASSERT_EQUAL((i >= 50 && i < 150) ? 200 + i - 50 : -1, canvasIndexAt(leds[1][i]));
+        TEST_ASSERT_EQUAL(0, leds[2][i].r + leds[2][i].g + leds[2][i].b);
+        TEST_ASSERT_EQUAL(0, leds[3][i].r + leds[3][i].g + leds[3][i].b);
+    }
+
+    // Runs off the end of a strip or segment are rejected; the old layout stays
+    const SegmentRun pastStrip[] = {{0, 0, 3, 150, 100, false}};
+    const SegmentRun pastSegment[] = {{2, 50, 2, 0, 100, false}};
+    const SegmentRun reversedPastStart[] = {{0, 0, 2, 50, 100, true}};
+    TEST_ASSERT_FALSE(canvas.setLayout(pastStrip));
+    TEST_ASSERT_FALSE(canvas.setLayout(pastSegment));
+    TEST_ASSERT_FALSE(canvas.setLayout(reversedPastStart));
+    canvas.gather(strips);
+    TEST_ASSERT_EQUAL(250, canvasIndexAt(leds[1][100]));
+}
+
+void test_canvas_animation_renders_without_layout_knowledge() {
+    // A one-segment animation drives all four strips through the canvas
+    static TriadicRain<1, 800> anim;
+    static LedCanvas<1, 800, 4, 200> canvas;
+    static CRGB leds[4][200];
+    CRGB* strips[4] = {leds[0], leds[1], leds[2], leds[3]};
+    const SegmentRun layout[] = {
+        {0, 0, 0, 0, 200, false},
+        {0, 200, 1, 0, 200, false},
+        {0, 400, 2, 0, 200, false},
+        {0, 600, 3, 0, 200, false},
+    };
+    TEST_ASSERT_TRUE(canvas.setLayout(layout));
+
+    anim.begin();
+    anim.update(50);
+    anim.render(canvas.segments());
+    canvas.gather(strips);
+
+    for (int ch = 0; ch < 4; ch++) {
+        for (int i = 0; i < 200; i++) {
+            const CRGB& src = canvas.segments()[0][ch * 200 + i];
+            TEST_ASSERT_EQUAL(src.r, leds[ch][i].r);
+            TEST_ASSERT_EQUAL(src.g, leds[ch][i].g);
+            TEST_ASSERT_EQUAL(src.b, leds[ch][i].b);
+        }
+    }
+}
+
+// ========== Frame Slicing Tests ==========
+
+// Simulated microsecond clock for the slicer
+static unsigned long sliceClockUs = 0;
+static unsigned long sliceClock() { return sliceClockUs; }
+
+// Wall clock for slicer benchmarks
+static unsigned long wallClockUs() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Animation whose slices take a fixed (simulated) time and record their order
+class FixedCostSliceAnimation : public TestAnimation {
+public:
+    static constexpr unsigned long SLICE_US = 300;
+    uint16_t computed = 0;
+    bool inOrder = true;
+
+    bool beginFrame(unsigned long deltaMs) override { (void)deltaMs; computed = 0; return true; }
+    uint16_t frameSlices() const override { return FRAME_SLICES; }
+    void computeSlice(uint16_t slice, CRGB* const channels[TEST_CHANNELS]) override {
+        (void)channels;
+        if (slice != computed) inOrder = false;
+        computed++;
+        sliceClockUs += SLICE_US;
+    }
+};
+
+// Run a due frame to completion; returns the number of run() calls it took
+template <typename Anim, typename Slicer>
+static int computeSlicedFrame(Anim& anim, Slicer& slicer, CRGB* const strips[], unsigned long deltaMs) {
+    if (!anim.beginFrame(deltaMs)) return 0;
+    slicer.start(anim.frameSlices());
+    int runs = 1;
+    while (!slicer.run(&anim, strips)) runs++;
+    return runs;
+}
+
+void test_slicer_stops_at_budget_and_resumes() {
+    static FixedCostSliceAnimation anim;
+    static CRGB leds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> slicer(sliceClock, 1000);
+
+    // 300 us slices under a 1000 us budget: 4 slices per run, then yield
+    TEST_ASSERT_TRUE(anim.beginFrame(0));
+    slicer.start(anim.frameSlices());
+    TEST_ASSERT_FALSE(slicer.run(&anim, strips));
+    TEST_ASSERT_EQUAL(4, anim.computed);
+    TEST_ASSERT_TRUE(slicer.inProgress());
+
+    int runs = 1;
+    while (!slicer.run(&anim, strips)) runs++;
+    runs++;
+    TEST_ASSERT_EQUAL(anim.frameSlices(), anim.computed);
+    TEST_ASSERT_TRUE(anim.inOrder);
+    TEST_ASSERT_EQUAL((anim.frameSlices() + 3) / 4, runs);
+
+    // No run held the caller longer than the budget plus one slice
+    TEST_ASSERT_TRUE(slicer.getMaxRunUs() < 1000 + FixedCostSliceAnimation::SLICE_US);
+    TEST_ASSERT_FALSE(slicer.inProgress());
+}
+
+void test_slice_size_is_independent_of_strip_length() {
+    // Longer strips mean more slices per frame, not longer slices
+    typedef AnimationBase<4, 200> Short;
+    typedef AnimationBase<4, 600> Long;
+    TEST_ASSERT_EQUAL(Short::SLICE_LEDS, Long::SLICE_LEDS);
+    TEST_ASSERT_EQUAL(16, Short::FRAME_SLICES);
+    TEST_ASSERT_EQUAL(48, Long::FRAME_SLICES);
+    TEST_ASSERT_EQUAL(4, (AnimationBase<1, 160>::FRAME_SLICES));   // Partial last slice
+
+    TriadicRain<4, 600> rain;
+    TEST_ASSERT_EQUAL(48, rain.frameSlices());
+}
+
+void test_sliced_frame_does_not_depend_on_budget() {
+    // The same frame comes out whether it is computed in one run or one slice per run
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> whole;
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> sliced;
+    static CRGB wholeLeds[TEST_CHANNELS][TEST_LEDS];
+    static CRGB slicedLeds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* wholeStrips[] = {wholeLeds[0], wholeLeds[1], wholeLeds[2], wholeLeds[3]};
+    CRGB* slicedStrips[] = {slicedLeds[0], slicedLeds[1], slicedLeds[2], slicedLeds[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> unlimited(sliceClock, 0xFFFFFFFF);
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> oneSlice(sliceClock, 0);
+    whole.begin();
+    sliced.begin();
+
+    for (int frame = 0; frame < 20; frame++) {
+        std::srand(100 + frame);
+        TEST_ASSERT_EQUAL(1, computeSlicedFrame(whole, unlimited, wholeStrips, 50));
+        std::srand(100 + frame);
+        TEST_ASSERT_EQUAL(TEST_CHANNELS * 4, computeSlicedFrame(sliced, oneSlice, slicedStrips, 50));
+    }
+    for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_LEDS; i++) {
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].r, slicedLeds[ch][i].r);
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].g, slicedLeds[ch][i].g);
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].b, slicedLeds[ch][i].b);
+        }
+    }
+}
+
+void test_sliced_twinkle_matches_update_and_render() {
+    // Twinkle steps its state in slice 0, so slicing reproduces update() + render()
+    static MonochromaticTwinkle<TEST_CHANNELS, TEST_LEDS> reference;
+    static MonochromaticTwinkle<TEST_CHANNELS, TEST_LEDS> sliced;
+    static CRGB refLeds[TEST_CHANNELS][TEST_LEDS];
+    static CRGB slicedLeds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* refStrips[] = {refLeds[0], refLeds[1], refLeds[2], refLeds[3]};
+    CRGB* slicedStrips[] = {slicedLeds[0], slicedLeds[1], slicedLeds[2], slicedLeds[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> slicer(sliceClock, 0);
+    std::srand(9);
+    reference.begin();
+    std::srand(9);
+    sliced.begin();
+
+    for (int frame = 0; frame < 10; frame++) {
+        std::srand(200 + frame);
+        TEST_ASSERT_TRUE(reference.update(50));
+        reference.render(refStrips);
+        std::srand(200 + frame);
+        computeSlicedFrame(sliced, slicer, slicedStrips, 50);
+    }
+    for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_LEDS; i++) {
+            TEST_ASSERT_EQUAL(refLeds[ch][i].r, slicedLeds[ch][i].r);
+            TEST_ASSERT_EQUAL(refLeds[ch][i].g, slicedLeds[ch][i].g);
+            TEST_ASSERT_EQUAL(refLeds[ch][i].b, slicedLeds[ch][i].b);
+        }
+    }
+}
+
+// Every LED of an 8 x 600 layout is written by a sliced frame
+template <typename Anim>
+static void checkSlicedCoverage8x600() {
+    static Anim anim;
+    static CRGB leds[8][600];
+    CRGB* strips[8];
+    for (int ch = 0; ch < 8; ch++) {
+        strips[ch] = leds[ch];
+        for (int i = 0; i < 600; i++) leds[ch][i] = CRGB(1, 2, 3);
+    }
+    FrameSlicer<8, 600> slicer(sliceClock, 0);
+    anim.begin();
+    TEST_ASSERT_EQUAL(8 * 12, computeSlicedFrame(anim, slicer, strips, anim.frameIntervalMs()));
+
+    for (int ch = 0; ch < 8; ch++) {
+        for (int i = 0; i < 600; i++) {
+            TEST_ASSERT_FALSE(leds[ch][i].r == 1 && leds[ch][i].g == 2 && leds[ch][i].b == 3);
+        }
+    }
+}
+
+void test_sliced_frames_cover_every_led() {
+    checkSlicedCoverage8x600<TriadicRain<8, 600>>();
+    checkSlicedCoverage8x600<MonochromaticRunner<8, 600>>();
+    checkSlicedCoverage8x600<TriadicTwinkle<8, 600>>();
+    checkSlicedCoverage8x600<MonochromaticTwinkle<8, 600>>();
+}
+
+void test_slicing_benchmark() {
+    // Whole-frame cost vs the longest single run under a small budget, 4 x 600
+    static TriadicRain<4, 600> anim;
+    static CRGB leds[4][600];
+    CRGB* strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    FrameSlicer<4, 600> unlimited(wallClockUs, 0xFFFFFFFF);
+    FrameSlicer<4, 600> budgeted(wallClockUs, 20);
+    anim.begin();
+
+    double wholeUs = benchmarkUs(500, [&]() { computeSlicedFrame(anim, unlimited, strips, 50); });
+    int runs = 0;
+    double frameUs = benchmarkUs(500, [&]() { runs += computeSlicedFrame(anim, budgeted, strips, 50); });
+    char msg[128];
+    snprintf(msg, sizeof(msg), "Triadic Rain 4x600: frame %.1f us in one run; %.1f us in %.1f runs, longest run %lu us",
+             wholeUs, frameUs, runs / 500.0, (unsigned long)budgeted.getMaxRunUs());
+    TEST_MESSAGE(msg);
+}
+
+// ========== Quality Governor Tests ==========
+
+void test_governor_degrades_over_budget_and_recovers() {
+    QualityGovernor governor(20000);
+    governor.reset(4);
+
+    // Steady frames over budget: one step per settle period, down to the last level
+    for (int frame = 0; frame < 5; frame++) governor.update(30000);
+    TEST_ASSERT_EQUAL(1, governor.level());
+    for (int frame = 0; frame < 50; frame++) governor.update(30000);
+    TEST_ASSERT_EQUAL(3, governor.level());
+
+    // Between the thresholds: hold
+    for (int frame = 0; frame < 100; frame++) governor.update(15000);
+    TEST_ASSERT_EQUAL(3, governor.level());
+
+    // Well under budget: recover one level per RECOVER_FRAMES
+    for (int frame = 0; frame < QualityGovernor::RECOVER_FRAMES + 10; frame++) governor.update(5000);
+    TEST_ASSERT_EQUAL(2, governor.level());
+    for (int frame = 0; frame < 3 * (QualityGovernor::RECOVER_FRAMES + QualityGovernor::SETTLE_FRAMES); frame++) {
+        governor.update(5000);
+    }
+    TEST_ASSERT_EQUAL(0, governor.level());
+}
+
+void test_quality_level_is_clamped_to_declared_levels() {
+    TestAnimation plain;
+    plain.setQuality(3);
+    TEST_ASSERT_EQUAL(0, plain.getQuality());
+
+    // Four levels, then one per coarser base grid (1 -> 2 -> 4 -> 8)
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> rain;
+    TEST_ASSERT_EQUAL(7, rain.qualityLevels());
+    rain.setQuality(9);
+    TEST_ASSERT_EQUAL(6, rain.getQuality());
+    rain.setQuality(0);
+}
+
+// Slices get cheaper with each quality level
+class LoadedSliceAnimation : public TestAnimation {
+public:
+    static constexpr unsigned long SLICE_US[4] = {400, 250, 150, 100};
+
+    bool beginFrame(unsigned long deltaMs) override { (void)deltaMs; return true; }
+    uint16_t frameSlices() const override { return FRAME_SLICES; }
+    void computeSlice(uint16_t slice, CRGB* const channels[TEST_CHANNELS]) override {
+        (void)slice;
+        (void)channels;
+        sliceClockUs += SLICE_US[getQuality()];
+    }
+    uint8_t qualityLevels() const override { return 4; }
+};
+
+// Loop passes: other tasks take loadUs, then the render task runs its slices
+static uint32_t runLoadedFrame(LoadedSliceAnimation& anim, FrameSlicer<TEST_CHANNELS, TEST_LEDS>& slicer,
+                               QualityGovernor& governor, CRGB* const strips[], unsigned long loadUs) {
+    anim.beginFrame(50);
+    slicer.start(anim.frameSlices());
+    do {
+        sliceClockUs += loadUs;
+    } while (!slicer.run(&anim, strips));
+    anim.setQuality(governor.update(slicer.getLastFrameUs()));
+    return slicer.getLastFrameUs();
+}
+
+void test_governor_keeps_frame_time_within_budget_under_load() {
+    static LoadedSliceAnimation anim;
+    static CRGB leds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> slicer(sliceClock, 1000);
+    QualityGovernor governor(20000);
+    governor.reset(anim.qualityLevels());
+
+    // Light load: full quality fits
+    uint32_t frameUs = 0;
+    for (int frame = 0; frame < 20; frame++) frameUs = runLoadedFrame(anim, slicer, governor, strips, 500);
+    TEST_ASSERT_EQUAL(0, anim.getQuality());
+    TEST_ASSERT_TRUE(frameUs <= 20000);
+
+    // Heavy load (3 ms of other work per pass): full quality takes 6 passes = 25.2 ms
+    for (int frame = 0; frame < 40; frame++) frameUs = runLoadedFrame(anim, slicer, governor, strips, 3000);
+    TEST_ASSERT_TRUE(anim.getQuality() > 0);
+    TEST_ASSERT_TRUE(frameUs <= 20000);
+    TEST_ASSERT_TRUE(governor.averageFrameUs() <= 20000);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "Synthetic 3 ms load: quality level %d, %lu us/frame (budget 20000 us)",
+             anim.getQuality(), (unsigned long)governor.averageFrameUs());
+    TEST_MESSAGE(msg);
+
+    // Load gone: back to full detail, still within budget
+    for (int frame = 0; frame < 200; frame++) frameUs = runLoadedFrame(anim, slicer, governor, strips, 500);
+    TEST_ASSERT_EQUAL(0, anim.getQuality());
+    TEST_ASSERT_TRUE(frameUs <= 20000);
+}
+
+void test_reduced_quality_steps_base_layer_every_other_frame() {
+    static TriadicRainProbe rain;
+    rain.begin();
+
+    // Full quality: the base layer moves every frame
+    uint32_t before = rain.baseChecksum();
+    rain.update(50);
+    TEST_ASSERT_NOT_EQUAL(before, rain.baseChecksum());
+
+    // Half-rate base: exactly one of each pair of frames moves it
+    rain.setQuality(TriadicRainProbe::QUALITY_HALF_RATE_BASE);
+    int moved = 0;
+    for (int frame = 0; frame < 10; frame++) {
+        before = rain.baseChecksum();
+        rain.update(50);
+        if (rain.baseChecksum() != before) moved++;
+    }
+    TEST_ASSERT_EQUAL(5, moved);
+}
+
+void test_quality_levels_benchmark() {
+    // Per-frame cost of rain at each quality level
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> anim;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    anim.begin();
+
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "Triadic Rain us/frame by quality:");
+    for (uint8_t level = 0; level < anim.qualityLevels(); level++) {
+        anim.setQuality(level);
+        double us = benchmarkUs(1000, [&]() {
+            anim.update(50);
+            anim.render(strips);
+        });
+        len += snprintf(msg + len, sizeof(msg) - len, " %d=%.1f", level, us);
+    }
+    anim.setQuality(0);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Base Layer Detail Tests ==========
+
+// Rain with its base grid exposed, at a chosen decimation
+template <uint8_t DECIMATION>
+class LodRain : public RainAnimationBase<LodRain<DECIMATION>, TEST_CHANNELS, TEST_LEDS,
+                                         MarkovBaseLayer<TEST_CHANNELS, TEST_LEDS, DECIMATION>> {
+public:
+    typedef MarkovBaseLayer<TEST_CHANNELS, TEST_LEDS, DECIMATION> Layer;
+    typedef RainAnimationBase<LodRain<DECIMATION>, TEST_CHANNELS, TEST_LEDS, Layer> Rain;
+    using Rain::BASE_POINTS;
+    using Rain::baseBrightness;
+    using Rain::hueOffset;
+
+    const char* getName() const override { return "LOD Rain"; }
+    static constexpr int HARMONY_OFFSETS[] = {0, 120, 240};
+
+    // Clear the raindrops and flatten the grid to one brightness
+    void flatten(uint8_t brightness) {
+        this->reset();
+        for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+            for (int g = 0; g < BASE_POINTS; g++) baseBrightness[ch][g] = brightness;
+        }
+    }
+};
+
+static uint16_t levelOf(const CRGB& c) { return c.r + c.g + c.b; }
+
+void test_base_lod_sizes_state_by_decimation() {
+    TEST_ASSERT_EQUAL(TEST_LEDS, LodRain<1>::BASE_POINTS);
+    TEST_ASSERT_EQUAL(101, LodRain<2>::BASE_POINTS);
+    TEST_ASSERT_EQUAL(51, LodRain<4>::BASE_POINTS);
+    TEST_ASSERT_EQUAL(26, LodRain<8>::BASE_POINTS);
+    TEST_ASSERT_TRUE(sizeof(LodRain<4>) + 4 * TEST_CHANNELS * 140 < sizeof(LodRain<1>));
+
+    // The governor can only coarsen up to every 8th LED
+    static LodRain<4> coarse;
+    TEST_ASSERT_EQUAL(5, coarse.qualityLevels());
+    coarse.setQuality(coarse.qualityLevels() - 1);
+    TEST_ASSERT_EQUAL(3, coarse.getBaseShift());
+}
+
+void test_base_lod_upsamples_smoothly() {
+    static LodRain<4> rain;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    rain.flatten(40);
+    rain.baseBrightness[0][1] = 200;    // LED 4
+
+    rain.render(strips);
+    TEST_ASSERT_EQUAL(levelOf(ch[0][16]), levelOf(ch[0][0]));    // Flat grid away from LED 4
+    TEST_ASSERT_TRUE(levelOf(ch[0][4]) > levelOf(ch[0][0]));
+    for (int i = 1; i <= 4; i++) TEST_ASSERT_TRUE(levelOf(ch[0][i]) > levelOf(ch[0][i - 1]));
+    for (int i = 5; i <= 8; i++) TEST_ASSERT_TRUE(levelOf(ch[0][i]) < levelOf(ch[0][i - 1]));
+    TEST_ASSERT_EQUAL(levelOf(ch[0][0]), levelOf(ch[0][8]));
+    // Smoothstep: eases out of the grid points
+    TEST_ASSERT_TRUE(levelOf(ch[0][1]) - levelOf(ch[0][0]) < levelOf(ch[0][2]) - levelOf(ch[0][1]));
+}
+
+void test_base_lod_steps_only_grid_points() {
+    static LodRain<8> rain;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> slicer(sliceClock, 1000000);
+    rain.begin();
+
+    // Sliced frames step the grid, the point past the end (last slice) included
+    int stepped = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        uint8_t before[LodRain<8>::BASE_POINTS];
+        for (int g = 0; g < LodRain<8>::BASE_POINTS; g++) before[g] = rain.baseBrightness[0][g];
+        computeSlicedFrame(rain, slicer, strips, rain.frameIntervalMs());
+        if (rain.baseBrightness[0][LodRain<8>::BASE_POINTS - 1] != before[LodRain<8>::BASE_POINTS - 1]) stepped++;
+    }
+    TEST_ASSERT_TRUE(stepped > 0);
+}
+
+void test_base_lod_follows_quality_without_jumps() {
+    static TriadicRainProbe rain;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    rain.begin();
+    for (int frame = 0; frame < 50; frame++) rain.update(rain.frameIntervalMs());
+    rain.render(strips);
+    CRGB full[TEST_LEDS];
+    for (int i = 0; i < TEST_LEDS; i++) full[i] = ch[2][i];
+
+    // Coarsest level: every 8th LED keeps its color, the rest is blended
+    rain.setQuality(rain.qualityLevels() - 1);
+    TEST_ASSERT_EQUAL(3, rain.getBaseShift());
+    rain.render(strips);
+    for (int i = 0; i < TEST_LEDS; i += 8) TEST_ASSERT_EQUAL(levelOf(full[i]), levelOf(ch[2][i]));
+
+    // Back to full detail: grid points still match, in-between LEDs interpolated
+    rain.setQuality(0);
+    TEST_ASSERT_EQUAL(0, rain.getBaseShift());
+    rain.render(strips);
+    for (int i = 0; i < TEST_LEDS; i += 8) TEST_ASSERT_EQUAL(levelOf(full[i]), levelOf(ch[2][i]));
+}
+
+void test_base_lod_benchmark() {
+    // Frame cost (update + render, 4 x 200) and base state by decimation
+    static LodRain<1> d1;
+    static LodRain<2> d2;
+    static LodRain<4> d4;
+    static LodRain<8> d8;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    AnimationBase<TEST_CHANNELS, TEST_LEDS>* anims[] = {&d1, &d2, &d4, &d8};
+    const uint16_t points[] = {LodRain<1>::BASE_POINTS, LodRain<2>::BASE_POINTS, LodRain<4>::BASE_POINTS,
+                               LodRain<8>::BASE_POINTS};
+
+    char msg[160];
+    int len = snprintf(msg, sizeof(msg), "Rain base layer by decimation (us/frame, state bytes):");
+    for (int d = 0; d < 4; d++) {
+        anims[d]->begin();
+        double us = benchmarkUs(1000, [&]() {
+            anims[d]->update(50);
+            anims[d]->render(strips);
+        });
+        len += snprintf(msg + len, sizeof(msg) - len, " %d=%.1f/%d", 1 << d, us, 4 * TEST_CHANNELS * points[d]);
+    }
+    TEST_MESSAGE(msg);
+}
+
+// ========== Runner Motion Tests ==========
+
+void test_subpixel_lut_phases_shift_the_blob() {
+    // Phase 0 is the whole-pixel table; each phase moves the centroid by 1/PHASES pixel
+    constexpr auto whole = makeGaussianBlendLut<MonochromaticRunnerProbe::RUNNER_LENGTH>(MonochromaticRunnerProbe::GAUSSIAN_VARIANCE.toDouble());
+    for (int k = 0; k < MonochromaticRunnerProbe::RUNNER_LENGTH; k++) {
+        TEST_ASSERT_EQUAL(whole[k], MonochromaticRunnerProbe::gaussianLUT[0][k]);
+    }
+    double previous = -1;
+    for (int phase = 0; phase < MonochromaticRunnerProbe::SUBPIXEL_PHASES; phase++) {
+        double sum = 0, weighted = 0;
+        for (int k = 0; k <= MonochromaticRunnerProbe::RUNNER_LENGTH; k++) {
+            sum += MonochromaticRunnerProbe::gaussianLUT[phase][k];
+            weighted += k * MonochromaticRunnerProbe::gaussianLUT[phase][k];
+        }
+        double centroid = weighted / sum;
+        TEST_ASSERT_FLOAT_WITHIN(0.05, MonochromaticRunnerProbe::RUNNER_LENGTH / 2.0 + (double)phase / MonochromaticRunnerProbe::SUBPIXEL_PHASES,
+                                  centroid);
+        TEST_ASSERT_TRUE(centroid > previous);
+        previous = centroid;
+    }
+}
+
+// Centroid of the runner on channel 0 (blend above the flat base)
+static double renderedRunnerCentroid(MonochromaticRunnerProbe& runner, int32_t headRaw) {
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    runner.place(headRaw);
+    runner.render(strips);
+    int base = ch[0][TEST_LEDS - 1].r + ch[0][TEST_LEDS - 1].g + ch[0][TEST_LEDS - 1].b;
+    double sum = 0, weighted = 0;
+    for (int i = 0; i < TEST_LEDS; i++) {
+        int lift = ch[0][i].r + ch[0][i].g + ch[0][i].b - base;
+        sum += lift;
+        weighted += (double)i * lift;
+    }
+    return weighted / sum;
+}
+
+void test_runner_renders_between_pixels() {
+    static MonochromaticRunnerProbe runner;
+    double at50 = renderedRunnerCentroid(runner, 50 << 16);
+    double at50half = renderedRunnerCentroid(runner, (50 << 16) + (1 << 15));
+    double at51 = renderedRunnerCentroid(runner, 51 << 16);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 0.5, at50half - at50);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 1.0, at51 - at50);
+}
+
+void test_runner_speed_independent_of_frame_rate() {
+    // One second of frames at 20 and at 5 fps: both travel RUNNER_SPEED pixels
+    static MonochromaticRunnerProbe runner;
+    const unsigned long intervals[] = {50, 200};
+    for (unsigned long interval : intervals) {
+        runner.intervalMs = interval;
+        runner.place(0);
+        runner.runners[0].velocity[0] = Q8_8::fromRatio(MonochromaticRunnerProbe::RUNNER_SPEED * interval, 1000);
+        for (unsigned long t = 0; t < 1000; t += interval) runner.update(interval);
+        TEST_ASSERT_EQUAL(MonochromaticRunnerProbe::RUNNER_SPEED, runner.runners[0].pos[0].round());
+    }
+    runner.intervalMs = MonochromaticRunnerProbe::RUNNER_FRAME_MS;
+}
+
+void test_runner_spawns_at_frame_rate_speed() {
+    // A new runner's velocity covers RUNNER_SPEED per second at the animation's frame rate
+    static MonochromaticRunnerProbe runner;
+    runner.intervalMs = 100;
+    runner.begin();
+    int spawned = 0;
+    for (int frame = 0; frame < 200 && !spawned; frame++) {
+        runner.update(100);
+        runner.runners[1].forEach([&](uint8_t r) {
+            TEST_ASSERT_TRUE(runner.runners[1].velocity[r] == Q8_8::fromInt(2));
+            spawned++;
+        });
+    }
+    TEST_ASSERT_TRUE(spawned > 0);
+    runner.intervalMs = MonochromaticRunnerProbe::RUNNER_FRAME_MS;
+}
+
+// ========== Particle Pool Tests ==========
+
+void test_particle_pool_allocates_lowest_free_slot() {
+    ParticlePool<6> pool;
+    TEST_ASSERT_EQUAL(0, pool.count());
+    for (int i = 0; i < 6; i++) TEST_ASSERT_EQUAL(i, pool.allocate());
+    TEST_ASSERT_TRUE(pool.full());
+    TEST_ASSERT_EQUAL(ParticlePool<6>::NONE, pool.allocate());
+
+    pool.release(4);
+    pool.release(1);
+    TEST_ASSERT_EQUAL(4, pool.count());
+    TEST_ASSERT_FALSE(pool.active(1));
+    TEST_ASSERT_EQUAL(1, pool.allocate());
+    TEST_ASSERT_EQUAL(4, pool.allocate());
+
+    ParticlePool<32> wide;
+    for (int i = 0; i < 32; i++) wide.allocate();
+    TEST_ASSERT_TRUE(wide.full());
+    TEST_ASSERT_EQUAL(32, wide.count());
+}
+
+void test_particle_pool_iterates_active_slots() {
+    ParticlePool<18> pool;
+    for (int i = 0; i < 10; i++) pool.age[pool.allocate()] = i;
+    pool.release(3);
+    pool.release(7);
+
+    // Visits active slots in order; releasing the visited slot is allowed
+    int visited = 0, last = -1;
+    pool.forEach([&](uint8_t slot) {
+        TEST_ASSERT_TRUE((int)slot > last);
+        last = slot;
+        visited++;
+        if (pool.age[slot] % 2 == 0) pool.release(slot);
+    });
+    TEST_ASSERT_EQUAL(8, visited);
+    TEST_ASSERT_EQUAL(3, pool.count());     // Odd ages left: slots 1, 5, 9
+    TEST_ASSERT_EQUAL(5, pool.find([&](uint8_t slot) { return pool.age[slot] > 3; }));
+    TEST_ASSERT_EQUAL(ParticlePool<18>::NONE, pool.find([&](uint8_t slot) { return pool.age[slot] > 9; }));
+}
+
+void test_occupancy_map_ranges() {
+    OccupancyMap<TEST_LEDS> map;
+    TEST_ASSERT_FALSE(map.any(0, TEST_LEDS - 1));
+
+    map.mark(28, 40);       // Across a word boundary
+    TEST_ASSERT_TRUE(map.test(28));
+    TEST_ASSERT_TRUE(map.test(31));
+    TEST_ASSERT_TRUE(map.test(32));
+    TEST_ASSERT_TRUE(map.test(40));
+    TEST_ASSERT_FALSE(map.test(27));
+    TEST_ASSERT_FALSE(map.test(41));
+    TEST_ASSERT_TRUE(map.any(0, 28));
+    TEST_ASSERT_TRUE(map.any(40, 100));
+    TEST_ASSERT_FALSE(map.any(41, 100));
+    TEST_ASSERT_FALSE(map.any(0, 27));
+
+    // Clipped to the strip
+    map.mark(-5, 2);
+    map.mark(TEST_LEDS - 3, TEST_LEDS + 10);
+    TEST_ASSERT_TRUE(map.test(0));
+    TEST_ASSERT_TRUE(map.test(TEST_LEDS - 1));
+    TEST_ASSERT_TRUE(map.any(-20, 0));
+    TEST_ASSERT_FALSE(map.any(-20, -1));
+    TEST_ASSERT_FALSE(map.any(TEST_LEDS, TEST_LEDS + 5));
+
+    map.unmark(30, 35);
+    TEST_ASSERT_TRUE(map.test(29));
+    TEST_ASSERT_FALSE(map.test(30));
+    TEST_ASSERT_FALSE(map.test(35));
+    TEST_ASSERT_TRUE(map.test(36));
+}
+
+void test_raindrop_collisions_match_distance_rule() {
+    // The map answers exactly the former test: a drop closer than RAINDROP_LENGTH
+    static TriadicRainProbe rain;
+    rain.begin();
+    for (int frame = 0; frame < 200; frame++) {
+        rain.update(50);
+        const TriadicRainProbe::RaindropPool& drops = rain.raindrops[2];
+        for (int pos = 0; pos < TEST_LEDS; pos++) {
+            bool near = false;
+            drops.forEach([&](uint8_t r) {
+                if (abs(pos - drops.pos[r].toInt()) < TriadicRainProbe::RAINDROP_LENGTH) near = true;
+            });
+            TEST_ASSERT_EQUAL(near, rain.checkCollision(2, pos));
+        }
+    }
+    TEST_ASSERT_TRUE(rain.raindrops[2].count() > 0);
+}
+
+void test_particle_pool_benchmark() {
+    // Spawn collision test for a full channel (18 raindrops): slot scan vs occupancy map
+    static TriadicRainProbe rain;
+    rain.begin();
+    const int dim[TEST_CHANNELS] = {0, 0, 0, 0};
+    rain.setChannelBrightnesses(dim);
+    for (int frame = 0; frame < 300; frame++) rain.update(50);
+    const TriadicRainProbe::RaindropPool& drops = rain.raindrops[0];
+    int16_t centers[TriadicRainProbe::MAX_RAINDROP_SLOTS];
+    bool active[TriadicRainProbe::MAX_RAINDROP_SLOTS];
+    for (int r = 0; r < TriadicRainProbe::MAX_RAINDROP_SLOTS; r++) {
+        active[r] = drops.active(r);
+        centers[r] = drops.pos[r].toInt();
+    }
+
+    volatile int hits = 0;
+    int pos = 0;
+    double scanUs = benchmarkUs(20000, [&]() {
+        bool hit = false;
+        for (int r = 0; r < TriadicRainProbe::MAX_RAINDROP_SLOTS; r++) {
+            if (active[r] && abs(pos - centers[r]) < TriadicRainProbe::RAINDROP_LENGTH) { hit = true; break; }
+        }
+        hits = hits + hit;
+        pos = (pos + 37) % TEST_LEDS;
+    });
+    double mapUs = benchmarkUs(20000, [&]() {
+        hits = hits + rain.checkCollision(0, pos);
+        pos = (pos + 37) % TEST_LEDS;
+    });
+    double frameUs = benchmarkUs(1000, [&]() { rain.update(50); });
+    char msg[160];
+    snprintf(msg, sizeof(msg), "%d raindrops: collision test %.3f us (scan) / %.3f us (map); rain update %.1f us/frame",
+             drops.count(), scanUs, mapUs, frameUs);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Noise Base Layer Tests ==========
+
+// Rain on a chosen base layer engine, with the base layer exposed
+template <typename Layer>
+class LayerRain : public RainAnimationBase<LayerRain<Layer>, TEST_CHANNELS, TEST_LEDS, Layer> {
+public:
+    typedef RainAnimationBase<LayerRain<Layer>, TEST_CHANNELS, TEST_LEDS, Layer> Rain;
+    using Rain::baseStepDue;
+
+    const char* getName() const override { return "Layer Rain"; }
+    static constexpr int HARMONY_OFFSETS[] = {0, 120, 240};
+
+    void stepBase() { this->updateBaseLayer(); }
+};
+
+typedef MarkovBaseLayer<TEST_CHANNELS, TEST_LEDS> MarkovLayer;
+typedef NoiseBaseLayer<TEST_CHANNELS, TEST_LEDS> NoiseLayer;
+
+class NoiseRain : public LayerRain<NoiseLayer> {
+public:
+    using LayerRain<NoiseLayer>::baseHueAt;
+    using LayerRain<NoiseLayer>::baseBrightnessAt;
+    using LayerRain<NoiseLayer>::ANGLE_WIDTH;
+};
+
+// Same base layer on every channel and LED
+static bool sameBase(const NoiseRain& a, const NoiseRain& b) {
+    for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_LEDS; i++) {
+            if (a.baseHueAt(ch, i) != b.baseHueAt(ch, i)) return false;
+            if (a.baseBrightnessAt(ch, i) != b.baseBrightnessAt(ch, i)) return false;
+        }
+    }
+    return true;
+}
+
+void test_noise_base_seeks_to_any_time() {
+    // The field depends only on the seed and the time: seeking lands on the same frame as running to it
+    static NoiseRain run;
+    static NoiseRain seek;
+    std::srand(31);
+    run.begin();
+    std::srand(31);
+    seek.begin();
+
+    for (int frame = 0; frame < 150; frame++) run.update(50);
+    TEST_ASSERT_EQUAL(150 * 50, run.getBaseTimeMs());
+    TEST_ASSERT_FALSE(sameBase(run, seek));
+    seek.seekBaseLayer(run.getBaseTimeMs());
+    TEST_ASSERT_TRUE(sameBase(run, seek));
+
+    // And back again
+    seek.seekBaseLayer(0);
+    run.begin();
+    TEST_ASSERT_FALSE(sameBase(run, seek));
+}
+
+void test_noise_base_is_smooth_and_bounded() {
+    static NoiseRain rain;
+    static uint8_t last[TEST_CHANNELS][TEST_LEDS];
+    rain.begin();
+    int maxStep = 0, maxNeighbour = 0, moved = 0;
+    for (int frame = 0; frame < 200; frame++) {
+        rain.update(50);
+        for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+            for (int i = 0; i < TEST_LEDS; i++) {
+                uint8_t bright = rain.baseBrightnessAt(ch, i);
+                TEST_ASSERT_TRUE(bright >= NoiseRain::BASE_BRIGHTNESS && bright <= NoiseRain::MAX_BRIGHTNESS);
+                TEST_ASSERT_TRUE(abs(rain.baseHueAt(ch, i)) <= NoiseRain::ANGLE_WIDTH / 2);
+                if (i > 0 && abs(bright - rain.baseBrightnessAt(ch, i - 1)) > maxNeighbour)
+                    maxNeighbour = abs(bright - rain.baseBrightnessAt(ch, i - 1));
+                if (frame > 0) {
+                    if (abs(bright - last[ch][i]) > maxStep) maxStep = abs(bright - last[ch][i]);
+                    if (bright != last[ch][i]) moved++;
+                }
+                last[ch][i] = bright;
+            }
+        }
+    }
+    // Brightness breathes (most LEDs change most frames) without flicker or hard edges
+    TEST_ASSERT_TRUE(moved > 199 * TEST_CHANNELS * TEST_LEDS / 2);
+    TEST_ASSERT_TRUE(maxStep <= 8);
+    TEST_ASSERT_TRUE(maxNeighbour <= 40);
+}
+
+void test_noise_base_half_rate_keeps_time() {
+    // Sampling every other frame keeps the speed: the sampled frames match full quality
+    static NoiseRain full;
+    static NoiseRain half;
+    std::srand(77);
+    full.begin();
+    std::srand(77);
+    half.begin();
+    half.setQuality(NoiseRain::QUALITY_HALF_RATE_BASE);
+
+    int sampled = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        full.update(50);
+        half.update(50);
+        TEST_ASSERT_EQUAL(full.getBaseTimeMs(), half.getBaseTimeMs());
+        if (half.baseStepDue) {
+            TEST_ASSERT_TRUE(sameBase(full, half));
+            sampled++;
+        }
+    }
+    TEST_ASSERT_EQUAL(10, sampled);
+}
+
+void test_noise_base_sliced_frame_matches_whole() {
+    // Slices sample only the cells they blend between; together they give the whole frame
+    static NoiseRain whole;
+    static NoiseRain sliced;
+    static CRGB wholeLeds[TEST_CHANNELS][TEST_LEDS];
+    static CRGB slicedLeds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* wholeStrips[] = {wholeLeds[0], wholeLeds[1], wholeLeds[2], wholeLeds[3]};
+    CRGB* slicedStrips[] = {slicedLeds[0], slicedLeds[1], slicedLeds[2], slicedLeds[3]};
+    FrameSlicer<TEST_CHANNELS, TEST_LEDS> oneSlice(sliceClock, 0);
+    std::srand(12);
+    whole.begin();
+    std::srand(12);
+    sliced.begin();
+
+    for (int frame = 0; frame < 20; frame++) {
+        std::srand(300 + frame);
+        TEST_ASSERT_TRUE(whole.update(50));
+        whole.render(wholeStrips);
+        std::srand(300 + frame);
+        computeSlicedFrame(sliced, oneSlice, slicedStrips, 50);
+    }
+    for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_LEDS; i++) {
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].r, slicedLeds[ch][i].r);
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].g, slicedLeds[ch][i].g);
+            TEST_ASSERT_EQUAL(wholeLeds[ch][i].b, slicedLeds[ch][i].b);
+        }
+    }
+}
+
+void test_noise_base_benchmark() {
+    // Base state and per-frame cost (4 x 200): Markov walk vs noise field
+    static LayerRain<MarkovLayer> markov;
+    static LayerRain<NoiseLayer> noise;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    const unsigned markovBytes = 4 * TEST_CHANNELS * TEST_LEDS;
+    const unsigned noiseBytes = 2 * TEST_CHANNELS * NoiseLayer::CELLS;
+    TEST_ASSERT_TRUE(sizeof(noise) + markovBytes - noiseBytes - 64 < sizeof(markov));
+
+    markov.begin();
+    noise.begin();
+    double markovBaseUs = benchmarkUs(1000, [&]() { markov.stepBase(); });
+    double noiseBaseUs = benchmarkUs(1000, [&]() { noise.stepBase(); });
+    double markovFrameUs = benchmarkUs(1000, [&]() {
+        markov.update(50);
+        markov.render(strips);
+    });
+    double noiseFrameUs = benchmarkUs(1000, [&]() {
+        noise.update(50);
+        noise.render(strips);
+    });
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "Base layer: Markov %u B, step %.1f us, frame %.1f us / noise %u B, sample %.1f us, frame %.1f us",
+             markovBytes, markovBaseUs, markovFrameUs, noiseBytes, noiseBaseUs, noiseFrameUs);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Frame Rate Tests ==========
+
+// Interval helpers exposed for testing
+struct IntervalProbe : public TestAnimation {
+    using TestAnimation::intervalForSpeed;
+    using TestAnimation::intervalForStep;
+};
+
+void test_frame_interval_helpers_clamp() {
+    TEST_ASSERT_EQUAL(50, IntervalProbe::intervalForSpeed(20));
+    TEST_ASSERT_EQUAL(10, IntervalProbe::intervalForSpeed(500));     // Capped at 100 fps
+    TEST_ASSERT_EQUAL(100, IntervalProbe::intervalForStep(16, 160));
+    TEST_ASSERT_EQUAL(200, IntervalProbe::intervalForStep(64, 100));  // Floor of 5 fps
+}
+
+void test_frame_interval_follows_content() {
+    typedef TriadicTwinkle<TEST_CHANNELS, TEST_LEDS> Twinkle;
+    static Twinkle twinkle;
+    typedef MonochromaticRunner<TEST_CHANNELS, TEST_LEDS> Runner;
+    static Runner runner;
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> rain;
+
+    // Slow twinkles run at 10 fps with per-frame steps scaled to keep their per-second rates
+    TEST_ASSERT_EQUAL(100, twinkle.frameIntervalMs());
+    TEST_ASSERT_EQUAL(Twinkle::FADE_PER_SECOND, Twinkle::FADE_SPEED * 1000 / Twinkle::TWINKLE_FRAME_MS);
+    TEST_ASSERT_EQUAL(Twinkle::TWINKLE_PERIOD_MS, Twinkle::TWINKLE_DENSITY * Twinkle::TWINKLE_FRAME_MS);
+    TEST_ASSERT_TRUE(Twinkle::FADE_SPEED <= Twinkle::MAX_LED_STEP);
+
+    // Runners: speed is independent of the frame rate
+    TEST_ASSERT_EQUAL(Runner::RUNNER_FRAME_MS, runner.frameIntervalMs());
+    TEST_ASSERT_EQUAL(50, rain.frameIntervalMs());
+}
+
+// Frames computed over simulated seconds of 10 ms render ticks
+template <typename Anim>
+static int framesPerSecond(Anim& anim, int seconds) {
+    int frames = 0;
+    for (int tick = 0; tick < seconds * 100; tick++) {
+        if (anim.update(10)) frames++;
+    }
+    return frames / seconds;
+}
+
+void test_frames_run_at_the_animation_rate() {
+    static TriadicTwinkle<TEST_CHANNELS, TEST_LEDS> twinkle;
+    static MonochromaticRunner<TEST_CHANNELS, TEST_LEDS> runner;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    twinkle.begin();
+    runner.begin();
+
+    TEST_ASSERT_EQUAL(10, framesPerSecond(twinkle, 5));
+    TEST_ASSERT_EQUAL(20, framesPerSecond(runner, 5));
+
+    // CPU per second follows the rate
+    double frameUs = benchmarkUs(1000, [&]() {
+        twinkle.update(twinkle.frameIntervalMs());
+        twinkle.render(strips);
+    });
+    char msg[96];
+    snprintf(msg, sizeof(msg), "Triadic Twinkle: %.1f us/frame, %.0f us/s at 10 fps (was %.0f us/s at 20 fps)",
+             frameUs, frameUs * 10, frameUs * 20);
+    TEST_MESSAGE(msg);
+}
+
+// ========== LED Output Tests ==========
+
+void test_wire_model_matches_ws2811_timing() {
+    // 24 bits x 1.25 us per pixel, plus the latch
+    TEST_ASSERT_EQUAL(200 * 30 + wire::RESET_US, wire::channelUs(200));
+    TEST_ASSERT_EQUAL(4 * wire::channelUs(200), wire::frameUs(4, 200, 1));
+    TEST_ASSERT_EQUAL(wire::channelUs(200), wire::frameUs(4, 200, 4));
+    TEST_ASSERT_EQUAL(2 * wire::channelUs(200), wire::frameUs(3, 200, 2));   // Lanes shared unevenly
+    TEST_ASSERT_EQUAL(39, wire::maxFps(wire::frameUs(4, 200, 1)));
+    TEST_ASSERT_EQUAL(159, wire::maxFps(wire::frameUs(4, 200, 4)));
+}
+
+// Simulated microsecond clock for output backends
+static unsigned long simNowUs = 0;
+static unsigned long simClockUs() { return simNowUs; }
+
+template <uint8_t CHANNELS, uint16_t LEDS>
+static void reportTopology(const char* name, uint8_t lanes) {
+    SimulatedOutput<CHANNELS, LEDS> output(simClockUs, lanes, true);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%-22s %u x %u, %u lane(s): %6lu us/frame, max %lu fps",
+             name, CHANNELS, LEDS, lanes, (unsigned long)output.frameTimeUs(), (unsigned long)output.maxFps());
+    TEST_MESSAGE(msg);
+}
+
+void test_simulated_output_reports_topology_fps() {
+    reportTopology<4, 200>("Serial (current)", 1);
+    reportTopology<4, 200>("Parallel RMT", 4);
+    reportTopology<8, 600>("Serial", 1);
+    reportTopology<8, 600>("Parallel RMT", 8);
+
+    // 8 x 600 is only usable at the 50 Hz output rate when sent in parallel
+    SimulatedOutput<8, 600> serial(simClockUs, 1, true);
+    SimulatedOutput<8, 600> parallel(simClockUs, 8, true);
+    TEST_ASSERT_LESS_THAN(50, serial.maxFps());
+    TEST_ASSERT_GREATER_OR_EQUAL(50, parallel.maxFps());
+}
+
+// Show every periodUs; the caller resumes when show() returns
+template <typename Output>
+static void simulateShows(Output& output, int frames, unsigned long periodUs) {
+    simNowUs = 0;
+    for (int f = 0; f < frames; f++) {
+        unsigned long due = (unsigned long)f * periodUs;
+        if (simNowUs < due) simNowUs = due;
+        output.show();
+        simNowUs += output.lastShowUs();
+    }
+}
+
+void test_simulated_output_blocking_vs_async() {
+    const unsigned long period = 20000;  // 50 Hz output task
+    const uint32_t frameUs = wire::frameUs(4, 200, 1);
+
+    // Blocking serial show holds the caller for the whole frame
+    SimulatedOutput<4, 200> blocking(simClockUs, 1, false);
+    simulateShows(blocking, 50, period);
+    TEST_ASSERT_EQUAL(50, blocking.frameCount());
+    TEST_ASSERT_EQUAL(50 * frameUs, blocking.totalBlockedUs());
+
+    // Async serial: the 25 ms frame overruns the 20 ms period, so once the wire
+    // saturates every show() waits out a whole frame anyway
+    SimulatedOutput<4, 200> asyncSerial(simClockUs, 1, true);
+    simulateShows(asyncSerial, 50, period);
+    TEST_ASSERT_GREATER_THAN(0, asyncSerial.totalBlockedUs());
+    TEST_ASSERT_EQUAL(frameUs, asyncSerial.lastShowUs());
+
+    // Async parallel: the wire is free again long before the next show
+    SimulatedOutput<4, 200> asyncParallel(simClockUs, 4, true);
+    simulateShows(asyncParallel, 50, period);
+    TEST_ASSERT_EQUAL(0, asyncParallel.totalBlockedUs());
+
+    asyncParallel.setBrightness(64);
+    TEST_ASSERT_EQUAL(64, asyncParallel.getBrightness());
+}
+
+// ========== Wire Encoding Tests ==========
+
+// Reference encoder: brightness, GRB order and pulse widths worked out bit by bit
+static void referenceEncode(const CRGB* leds, uint16_t count, uint8_t brightness, uint32_t* out) {
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t bytes[3] = {leds[i].g, leds[i].r, leds[i].b};
+        for (int c = 0; c < 3; c++) {
+            uint8_t value = (uint8_t)((bytes[c] * (brightness + 1)) >> 8);
+            for (int bit = 7; bit >= 0; bit--) {
+                bool one = (value >> bit) & 1;
+                uint32_t highTicks = one ? 16 : 8;      // 0.80 / 0.40 us at 50 ns
+                uint32_t lowTicks = one ? 9 : 17;       // 0.45 / 0.85 us
+                *out++ = highTicks | (1UL << 15) | (lowTicks << 16);
+            }
+        }
+    }
+    *out = (2800UL << 16) | 2800UL;                     // 280 us low latch
+}
+
+void test_wire_framebuffer_matches_reference_encoder() {
+    const uint16_t LEDS = 64;
+    static WireFramebuffer<2, LEDS> framebuffer;
+    static uint32_t expected[LEDS * 24 + 1];
+    CRGB leds[LEDS];
+    for (int i = 0; i < LEDS; i++) {
+        leds[i] = CRGB(random(256), random(256), random(256));
+    }
+    leds[0] = CRGB(0x01, 0x80, 0xFF);
+    leds[1] = CRGB::White;
+
+    const uint8_t brightnesses[] = {255, 64, 1, 0};
+    for (uint8_t brightness : brightnesses) {
+        framebuffer.setBrightness(brightness);
+        framebuffer.setChannel(1, leds);
+        referenceEncode(leds, LEDS, brightness, expected);
+        TEST_ASSERT_EQUAL(LEDS * 24 + 1, (int)(WireFramebuffer<2, LEDS>::SYMBOLS_PER_CHANNEL));
+        TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, framebuffer.channel(1), LEDS * 24 + 1);
+    }
+
+    // Every symbol is one 1.25 us bit, high first
+    TEST_ASSERT_EQUAL(25, (wire::ZERO & 0x7FFF) + ((wire::ZERO >> 16) & 0x7FFF));
+    TEST_ASSERT_EQUAL(25, (wire::ONE & 0x7FFF) + ((wire::ONE >> 16) & 0x7FFF));
+
+    // Untouched channel is black, still latched
+    TEST_ASSERT_EQUAL_UINT32(wire::ZERO, framebuffer.channel(0)[0]);
+    TEST_ASSERT_EQUAL_UINT32(expected[LEDS * 24], framebuffer.channel(0)[LEDS * 24]);
+}
+
+void test_wire_framebuffer_benchmark() {
+    static WireFramebuffer<4, TEST_LEDS> framebuffer;
+    static uint32_t reference[TEST_LEDS * 24 + 1];
+    static CRGB leds[TEST_LEDS];
+    for (int i = 0; i < TEST_LEDS; i++) {
+        leds[i] = CRGB(i, 255 - i, i * 3);
+    }
+    framebuffer.setBrightness(64);
+
+    double tableUs = benchmarkUs(500, [&]() {
+        for (uint8_t ch = 0; ch < 4; ch++) framebuffer.setChannel(ch, leds);
+    });
+    double bitwiseUs = benchmarkUs(500, [&]() {
+        for (uint8_t ch = 0; ch < 4; ch++) referenceEncode(leds, TEST_LEDS, 64, reference);
+    });
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(reference, framebuffer.channel(3), TEST_LEDS * 24 + 1);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "Wire encode 4 x 200: table %.1f us/frame, bitwise %.1f us/frame", tableUs, bitwiseUs);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Frame Interpolation Tests ==========
+
+typedef FrameInterpolator<TEST_CHANNELS, TEST_LEDS> TestInterpolator;
+
+void test_swar_lerp_matches_scalar() {
+    alignas(4) static uint8_t a[TestInterpolator::FRAME_WORDS * 4];
+    alignas(4) static uint8_t b[TestInterpolator::FRAME_WORDS * 4];
+    alignas(4) static uint8_t swar[TestInterpolator::FRAME_WORDS * 4];
+    static uint8_t scalar[TestInterpolator::FRAME_WORDS * 4];
+    std::srand(17);
+    for (uint32_t i = 0; i < sizeof(a); i++) {
+        a[i] = std::rand() & 0xFF;
+        b[i] = std::rand() & 0xFF;
+    }
+    a[0] = 0; b[0] = 255; a[1] = 255; b[1] = 0;     // Extremes in both directions
+
+    for (uint16_t w = 0; w <= 256; w++) {
+        TestInterpolator::lerpScalar(scalar, a, b, sizeof(a), w);
+        TestInterpolator::lerpWords(swar, a, b, TestInterpolator::FRAME_WORDS, w);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(scalar, swar, sizeof(a));
+    }
+    TestInterpolator::lerpWords(swar, a, b, TestInterpolator::FRAME_WORDS, 0);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(a, swar, sizeof(a));
+    TestInterpolator::lerpWords(swar, a, b, TestInterpolator::FRAME_WORDS, 256);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(b, swar, sizeof(a));
+}
+
+// Fill a test frame with one color
+static void fillFrame(CRGB (&leds)[TEST_CHANNELS][TEST_LEDS], const CRGB& color) {
+    for (int ch = 0; ch < TEST_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_LEDS; i++) leds[ch][i] = color;
+    }
+}
+
+void test_interpolator_blends_over_one_frame_interval() {
+    static TestInterpolator interp;
+    static CRGB leds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    interp.reset();
+    TEST_ASSERT_FALSE(interp.render(0));
+
+    // First frame shows at once
+    fillFrame(leds, CRGB(0, 0, 0));
+    interp.push(strips, 1000, 100);
+    TEST_ASSERT_TRUE(interp.render(1000));
+    TEST_ASSERT_EQUAL(0, interp.channels()[0][0].r);
+
+    // Next frame: reached linearly over the animation's frame interval
+    fillFrame(leds, CRGB(200, 100, 0));
+    interp.push(strips, 1000, 100);
+    interp.render(1000);
+    TEST_ASSERT_EQUAL(0, interp.channels()[2][50].r);
+    TEST_ASSERT_FALSE(interp.settled());
+    interp.render(1050);
+    TEST_ASSERT_EQUAL(100, interp.channels()[2][50].r);
+    TEST_ASSERT_EQUAL(50, interp.channels()[2][50].g);
+    interp.render(1100);
+    TEST_ASSERT_EQUAL(200, interp.channels()[3][199].r);
+    TEST_ASSERT_TRUE(interp.settled());
+    interp.render(1300);
+    TEST_ASSERT_EQUAL(200, interp.channels()[3][199].r);
+}
+
+void test_interpolator_early_frame_does_not_jump() {
+    static TestInterpolator interp;
+    static CRGB leds[TEST_CHANNELS][TEST_LEDS];
+    CRGB* strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    interp.reset();
+    fillFrame(leds, CRGB(0, 0, 0));
+    interp.push(strips, 0, 100);
+    fillFrame(leds, CRGB(200, 200, 200));
+    interp.push(strips, 0, 100);
+
+    // Halfway there, the next frame arrives: output continues from the blend on display
+    interp.render(50);
+    uint8_t shown = interp.channels()[1][10].g;
+    fillFrame(leds, CRGB(0, 0, 0));
+    interp.push(strips, 50, 100);
+    interp.render(50);
+    TEST_ASSERT_EQUAL(shown, interp.channels()[1][10].g);
+    interp.render(100);
+    TEST_ASSERT_EQUAL(shown / 2, interp.channels()[1][10].g);
+}
+
+void test_interpolation_benchmark() {
+    // Cost of simulating a frame vs blending an output frame, 4 x 200
+    static TriadicRain<TEST_CHANNELS, TEST_LEDS> anim;
+    static TestInterpolator interp;
+    static CRGB ch[TEST_CHANNELS][TEST_LEDS];
+    alignas(4) static uint8_t scratch[TestInterpolator::FRAME_WORDS * 4];
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    anim.begin();
+    interp.reset();
+    interp.push(strips, 0, 100);
+    anim.update(50);
+    anim.render(strips);
+    interp.push(strips, 0, 100);
+
+    double simulateUs = benchmarkUs(1000, [&]() {
+        anim.update(50);
+        anim.render(strips);
+    });
+    unsigned long t = 0;
+    double swarUs = benchmarkUs(5000, [&]() { interp.render(t++ % 100); });
+    const uint8_t* a = reinterpret_cast<const uint8_t*>(ch[0]);
+    double scalarUs = benchmarkUs(5000, [&]() {
+        TestInterpolator::lerpScalar(scratch, a, a, TestInterpolator::FRAME_BYTES, (uint16_t)(t++ & 0xFF));
+    });
+    char msg[128];
+    snprintf(msg, sizeof(msg), "4x200: simulate %.1f us/frame, interpolate %.1f us (SWAR) / %.1f us (scalar)",
+             simulateUs, swarUs, scalarUs);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Power Limiter Tests ==========
+
+static CRGB powerLeds[4][200];
+static CRGB* const powerStrips[4] = {powerLeds[0], powerLeds[1], powerLeds[2], powerLeds[3]};
+
+static void fillPowerLeds(const CRGB& color) {
+    for (int ch = 0; ch < 4; ch++) fill_solid(powerLeds[ch], 200, color);
+}
+
+// Feed the limiter the frame's per-channel R+G+B sums (as the output stage does)
+static void measurePower(PowerLimiter<4, 200>& limiter) {
+    uint32_t sums[4];
+    for (int ch = 0; ch < 4; ch++) {
+        sums[ch] = 0;
+        for (int i = 0; i < 200; i++) sums[ch] += (uint32_t)powerLeds[ch][i].r + powerLeds[ch][i].g + powerLeds[ch][i].b;
+    }
+    limiter.setChannelSums(sums);
+}
+
+void test_power_estimate_matches_led_model() {
+    PowerLimiter<4, 200> limiter(40000, 20, 1000);
+
+    // Full white: 60 mA per LED plus 1 mA idle (HARDWARE.md: 48 A worst case)
+    fillPowerLeds(CRGB::White);
+    measurePower(limiter);
+    TEST_ASSERT_EQUAL(48000 + 800, limiter.estimatedMa(255));
+    TEST_ASSERT_EQUAL(12000 + 200, limiter.channelMa(0, 255));
+    TEST_ASSERT_EQUAL(12000 + 800, limiter.estimatedMa(63));    // 25% brightness
+
+    // Black: idle current only
+    fillPowerLeds(CRGB::Black);
+    measurePower(limiter);
+    TEST_ASSERT_EQUAL(800, limiter.estimatedMa(255));
+}
+
+void test_power_estimate_from_output_stage_sums() {
+    // The output stage sums corrected values before brightness: full white is the worst case
+    static OutputStage<4, 200> stage;
+    static CRGB out[4][200];
+    CRGB* const outStrips[4] = {out[0], out[1], out[2], out[3]};
+    PowerLimiter<4, 200> limiter(40000, 20, 1000);
+    fillPowerLeds(CRGB::White);
+    uint32_t sums[4];
+    stage.process(powerStrips, outStrips, 64, sums);
+    limiter.setChannelSums(sums);
+    TEST_ASSERT_EQUAL(48000 + 800, limiter.estimatedMa(255));
+
+    // White balance halving green lowers the estimate by a sixth
+    stage.setCorrection(0, ColorMatrix::whiteBalance(1.0, 0.5, 1.0));
+    stage.process(powerStrips, outStrips, 64, sums);
+    limiter.setChannelSums(sums);
+    TEST_ASSERT_INT_WITHIN(10, 12200 - 2000, limiter.channelMa(0, 255));
+}
+
+void test_power_limiter_stays_within_budget() {
+    PowerLimiter<4, 200> limiter(10000, 20, 1000);
+
+    // Dim content passes untouched
+    fillPowerLeds(CRGB(10, 10, 10));
+    measurePower(limiter);
+    TEST_ASSERT_EQUAL(255, limiter.limit(255));
+
+    // Full white is cut on the very first frame
+    fillPowerLeds(CRGB::White);
+    measurePower(limiter);
+    uint8_t limited = limiter.limit(255);
+    TEST_ASSERT_LESS_OR_EQUAL(10000, limiter.limitedMa());
+    TEST_ASSERT_GREATER_THAN(10000 - 300, limiter.limitedMa());   // ... but no more than needed
+    TEST_ASSERT_EQUAL(limited, limiter.brightness());
+
+    // Lower request than the limit is honored as is
+    TEST_ASSERT_EQUAL(20, limiter.limit(20));
+}
+
+void test_power_limiter_recovers_smoothly() {
+    PowerLimiter<4, 200> limiter(10000, 20, 1000);
+    fillPowerLeds(CRGB::White);
+    measurePower(limiter);
+    uint8_t limited = limiter.limit(255);
+
+    // Content flickering between full white and dark every frame: no pumping
+    int maxBrightness = 0;
+    for (int frame = 0; frame < 100; frame++) {
+        fillPowerLeds((frame % 2) ? CRGB::White : CRGB::Black);
+        measurePower(limiter);
+        uint8_t b = limiter.limit(255);
+        if (b > maxBrightness) maxBrightness = b;
+        if (frame % 2) TEST_ASSERT_LESS_OR_EQUAL(10000, limiter.limitedMa());
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(limited + (PowerLimiter<4, 200>::RELEASE_STEP), maxBrightness);
+
+    // Dark content: back to full brightness in RELEASE_STEP increments
+    fillPowerLeds(CRGB::Black);
+    measurePower(limiter);
+    uint8_t previous = limiter.brightness();
+    int frames = 0;
+    while (limiter.limit(255) < 255) {
+        TEST_ASSERT_LESS_OR_EQUAL((PowerLimiter<4, 200>::RELEASE_STEP), limiter.brightness() - previous);
+        previous = limiter.brightness();
+        frames++;
+    }
+    TEST_ASSERT_GREATER_THAN(50, frames);
+}
+
+// ========== Output Stage Tests ==========
+
+static CRGB stageIn[4][200];
+static CRGB stageOut[4][200];
+static const CRGB* const stageInStrips[4] = {stageIn[0], stageIn[1], stageIn[2], stageIn[3]};
+static CRGB* const stageOutStrips[4] = {stageOut[0], stageOut[1], stageOut[2], stageOut[3]};
+
+void test_output_stage_applies_gamma() {
+    static OutputStage<4, 200> stage;
+    stage.setDithering(false);
+    for (int ch = 0; ch < 4; ch++) {
+        for (int i = 0; i < 200; i++) stageIn[ch][i] = CRGB(i, 255 - i, (i * 7) & 0xFF);
+    }
+    stageIn[0][0] = CRGB::Black;
+    stageIn[0][1] = CRGB::White;
+
+    uint32_t sums[4];
+    stage.process(stageInStrips, stageOutStrips, 255, sums);
+    for (int ch = 0; ch < 4; ch++) {
+        uint32_t expectedSum = 0;
+        for (int i = 0; i < 200; i++) {
+            TEST_ASSERT_INT_WITHIN(1, GAMMA8[stageIn[ch][i].r], stageOut[ch][i].r);
+            TEST_ASSERT_INT_WITHIN(1, GAMMA8[stageIn[ch][i].g], stageOut[ch][i].g);
+            TEST_ASSERT_INT_WITHIN(1, GAMMA8[stageIn[ch][i].b], stageOut[ch][i].b);
+            expectedSum += (GAMMA16[stageIn[ch][i].r] >> 8) + (GAMMA16[stageIn[ch][i].g] >> 8) + (GAMMA16[stageIn[ch][i].b] >> 8);
+        }
+        TEST_ASSERT_EQUAL(expectedSum, sums[ch]);
+    }
+    TEST_ASSERT_EQUAL(0, stageOut[0][0].r + stageOut[0][0].g + stageOut[0][0].b);
+    TEST_ASSERT_EQUAL(255 * 3, stageOut[0][1].r + stageOut[0][1].g + stageOut[0][1].b);
+}
+
+void test_output_stage_color_correction() {
+    static OutputStage<4, 200> stage;
+    stage.setDithering(false);
+    fill_solid(stageIn[0], 200, CRGB(200, 200, 200));
+    fill_solid(stageIn[1], 200, CRGB(255, 0, 100));
+    fill_solid(stageIn[2], 200, CRGB(200, 200, 200));
+    fill_solid(stageIn[3], 200, CRGB(200, 200, 200));
+
+    // Channel 0: white balance; channel 1: swap red and blue (crosstalk terms)
+    stage.setCorrection(0, ColorMatrix::whiteBalance(1.0, 0.5, 0.0));
+    const ColorMatrix swap = {{
+        {Q8_8::fromInt(0), Q8_8::fromInt(0), Q8_8::fromInt(1)},
+        {Q8_8::fromInt(0), Q8_8::fromInt(1), Q8_8::fromInt(0)},
+        {Q8_8::fromInt(1), Q8_8::fromInt(0), Q8_8::fromInt(0)},
+    }};
+    stage.setCorrection(1, swap);
+
+    uint32_t sums[4];
+    stage.process(stageInStrips, stageOutStrips, 255, sums);
+    TEST_ASSERT_EQUAL(stageOut[2][0].r, stageOut[0][0].r);
+    TEST_ASSERT_INT_WITHIN(1, stageOut[2][0].g / 2, stageOut[0][0].g);
+    TEST_ASSERT_EQUAL(0, stageOut[0][0].b);
+    TEST_ASSERT_INT_WITHIN(1, GAMMA8[100], stageOut[1][0].r);
+    TEST_ASSERT_EQUAL(0, stageOut[1][0].g);
+    TEST_ASSERT_EQUAL(255, stageOut[1][0].b);
+    TEST_ASSERT_LESS_THAN(sums[2], sums[0]);
+}
+
+void test_output_stage_dithering_averages_to_exact_level() {
+    static OutputStage<4, 200> stage;
+    const uint8_t brightness = 64;
+    for (int ch = 0; ch < 4; ch++) {
+        for (int i = 0; i < 200; i++) stageIn[ch][i] = CRGB(i, i, i);
+    }
+
+    // Sum each LED over one dither cycle
+    static uint32_t totals[200];
+    for (int i = 0; i < 200; i++) totals[i] = 0;
+    uint32_t sums[4];
+    for (int f = 0; f < OutputStage<4, 200>::DITHER_STEPS; f++) {
+        stage.process(stageInStrips, stageOutStrips, brightness, sums);
+        stage.nextFrame();
+        for (int i = 0; i < 200; i++) totals[i] += stageOut[0][i].r;
+    }
+
+    int steppedErrors = 0;
+    for (int i = 0; i < 200; i++) {
+        double exact = GAMMA16[i] * (brightness + 1) / 256.0 / 256.0;
+        double dithered = totals[i] / 8.0;
+        TEST_ASSERT_TRUE(fabs(dithered - exact) <= 1.0 / 16 + 1.0 / 256);
+
+        // Without dithering every level is rounded to a whole step
+        double rounded = floor(exact + 0.5);
+        if (fabs(rounded - exact) > 0.2) steppedErrors++;
+    }
+    TEST_ASSERT_GREATER_THAN(50, steppedErrors);
+
+    // Neighbouring LEDs of the same level are out of phase
+    stageIn[0][10] = stageIn[0][11] = CRGB(120, 120, 120);
+    int differ = 0;
+    for (int f = 0; f < 8; f++) {
+        stage.process(stageInStrips, stageOutStrips, brightness, sums);
+        stage.nextFrame();
+        if (stageOut[0][10].r != stageOut[0][11].r) differ++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, differ);
+}
+
+void test_output_stage_reprocessing_keeps_dither_phase() {
+    // Every other frame is redone at a lower (power-limited) brightness, as
+    // showLeds() does: the dither still steps once per shown frame
+    static OutputStage<4, 200> limited;
+    static OutputStage<4, 200> reference;
+    static CRGB expected[200];
+    for (int ch = 0; ch < 4; ch++) {
+        for (int i = 0; i < 200; i++) stageIn[ch][i] = CRGB(i, i, i);
+    }
+    uint32_t sums[4];
+    for (int f = 0; f < 2 * OutputStage<4, 200>::DITHER_STEPS; f++) {
+        reference.process(stageInStrips, stageOutStrips, 32, sums);
+        reference.nextFrame();
+        for (int i = 0; i < 200; i++) expected[i] = stageOut[0][i];
+
+        limited.process(stageInStrips, stageOutStrips, 64, sums);
+        if (f % 2) limited.process(stageInStrips, stageOutStrips, 32, sums);
+        limited.nextFrame();
+        if (f % 2) {
+            for (int i = 0; i < 200; i++) TEST_ASSERT_EQUAL(expected[i].r, stageOut[0][i].r);
+        }
+    }
+}
+
+void test_output_stage_benchmark() {
+    static OutputStage<4, 200> stage;
+    for (int ch = 0; ch < 4; ch++) {
+        for (int i = 0; i < 200; i++) stageIn[ch][i] = CRGB(i, 255 - i, i / 2);
+    }
+    uint32_t sums[4];
+    double diagonalUs = benchmarkUs(500, [&]() { stage.process(stageInStrips, stageOutStrips, 64, sums); });
+
+    const ColorMatrix crosstalk = {{
+        {Q8_8::fromDouble(0.9), Q8_8::fromDouble(0.1), Q8_8::fromInt(0)},
+        {Q8_8::fromDouble(0.05), Q8_8::fromDouble(0.8), Q8_8::fromDouble(0.05)},
+        {Q8_8::fromInt(0), Q8_8::fromDouble(0.1), Q8_8::fromDouble(0.9)},
+    }};
+    for (int ch = 0; ch < 4; ch++) stage.setCorrection(ch, crosstalk);
+    double fullUs = benchmarkUs(500, [&]() { stage.process(stageInStrips, stageOutStrips, 64, sums); });
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "Output stage 4 x 200: %.1f us/frame (white balance), %.1f us/frame (full matrix)",
+             diagonalUs, fullUs);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Lookup Table Tests ==========
+
+void test_lut_hue8_matches_map() {
+    for (int deg = 0; deg <= 360; deg++) {
+        TEST_ASSERT_EQUAL(map(deg, 0, 360, 0, 255), HUE8_FROM_DEGREES[deg]);
+    }
+    TEST_ASSERT_EQUAL(hue8FromDegrees(355), hue8FromDegrees(-5));
+    TEST_ASSERT_EQUAL(hue8FromDegrees(10), hue8FromDegrees(370));
+}
+
+void test_lut_curves_match_float() {
+    for (int i = 0; i < 256; i++) {
+        float r = i / 255.0f;
+        TEST_ASSERT_INT_WITHIN(1, (int)(powf(r, 2.2f) * 255.0f + 0.5f), GAMMA8[i]);
+        TEST_ASSERT_INT_WITHIN(1, (int)(r * r * r * 255.0f + 0.5f), CUBIC_BIAS8[i]);
+    }
+}
+
+void test_lut_gaussian_matches_expf() {
+    // Runner kernel (LENGTH 30, variance 2.5)
+    constexpr Lut<uint8_t, 30> kernel = makeGaussianBlendLut<30>(2.5);
+    for (int i = 0; i < 30; i++) {
+        float x = i - 15.0f;
+        TEST_ASSERT_INT_WITHIN(1, (int)(expf(-(x * x) / 5.0f) * 255.0f + 0.5f), kernel[i]);
+    }
+
+    // Raindrop fade table vs the former per-pixel float computation
+    constexpr auto fading = makeFadingGaussianLut<30, 5>(0.1, 10.0);
+    for (int frame = 0; frame < 30; frame++) {
+        for (int x = 0; x <= 5; x++) {
+            float progress = frame / 30.0f;
+            float variance = 0.1f + progress * 9.9f;
+            float blend = expf(-(x * x) / (2.0f * variance)) * (1.0f - progress);
+            TEST_ASSERT_INT_WITHIN(1, (int)(blend * 255.0f + 0.5f), fading[frame][x]);
+        }
+    }
+}
+
+// ========== Fixed-Point Tests ==========
+
+void test_fixed_q8_8_matches_float() {
+    const float step = 1.0f / 256.0f;
+    std::srand(42);
+
+    for (int i = 0; i < 1000; i++) {
+        // Operands within ±8 so products stay in range
+        float a = (std::rand() % 4096 - 2048) / 256.0f;
+        float b = (std::rand() % 4096 - 2048) / 256.0f;
+        Q8_8 qa = Q8_8::fromDouble(a);
+        Q8_8 qb = Q8_8::fromDouble(b);
+
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, a + b, (float)(qa + qb).toDouble());
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, a - b, (float)(qa - qb).toDouble());
+        TEST_ASSERT_FLOAT_WITHIN(step / 2, a * b, (float)(qa * qb).toDouble());
+        if (b >= 1.0f || b <= -1.0f) {
+            TEST_ASSERT_FLOAT_WITHIN(step / 2, a / b, (float)(qa / qb).toDouble());
+        }
+    }
+}
+
+void test_fixed_q16_16_precision() {
+    const double step = 1.0 / 65536.0;
+    TEST_ASSERT_FLOAT_WITHIN(step / 2, 0.1, Q16_16::fromRatio(1, 10).toDouble());
+    TEST_ASSERT_FLOAT_WITHIN(step / 2, 2.5, Q16_16::fromRatio(5, 2).toDouble());
+    // Operand error (1/2 step) is multiplied by 7, plus 1/2 step for the product
+    TEST_ASSERT_FLOAT_WITHIN(4 * step, 1.0 / 3.0 * 7.0, (Q16_16::fromRatio(1, 3) * Q16_16::fromInt(7)).toDouble());
+
+    // toInt floors, round() goes to nearest
+    TEST_ASSERT_EQUAL(-2, Q16_16::fromDouble(-1.25).toInt());
+    TEST_ASSERT_EQUAL(-1, Q16_16::fromDouble(-1.25).round());
+    TEST_ASSERT_EQUAL(3, Q16_16::fromDouble(2.5).round());
+    TEST_ASSERT_EQUAL(128, Q16_16::fromDouble(7.5).frac8());
+}
+
+void test_fixed_saturates() {
+    TEST_ASSERT_TRUE(Q8_8::max() + Q8_8::fromInt(1) == Q8_8::max());
+    TEST_ASSERT_TRUE(Q8_8::min() - Q8_8::fromInt(1) == Q8_8::min());
+    TEST_ASSERT_TRUE(Q8_8::fromInt(100) * Q8_8::fromInt(100) == Q8_8::max());
+    TEST_ASSERT_TRUE(Q8_8::fromInt(-100) * Q8_8::fromInt(100) == Q8_8::min());
+    TEST_ASSERT_TRUE(Q8_8::fromInt(1) / Q8_8::fromInt(0) == Q8_8::max());
+    TEST_ASSERT_TRUE(Q8_8::fromInt(-1) / Q8_8::fromInt(0) == Q8_8::min());
+    TEST_ASSERT_TRUE(Q8_8::fromInt(1000) == Q8_8::max());
+
+    // Q0.8 is unsigned and below 1.0
+    TEST_ASSERT_EQUAL(255, (Q0_8::fromRaw(200) + Q0_8::fromRaw(100)).raw);
+    TEST_ASSERT_EQUAL(0, (Q0_8::fromRaw(50) - Q0_8::fromRaw(100)).raw);
+    TEST_ASSERT_EQUAL(255, Q0_8::fromInt(1).raw);
+}
+
+void test_fixed_twinkle_target_matches_float() {
+    // Twinkle target brightness: 20 + r^3 * 235, formerly computed in float
+    for (int i = 0; i < 256; i++) {
+        float r = i / 255.0f;
+        int expected = 20 + (int)(r * r * r * 235.0f + 0.5f);
+        int actual = 20 + Q0_8::fromRaw(CUBIC_BIAS8[i]).scale(235);
+        TEST_ASSERT_INT_WITHIN(1, expected, actual);
+    }
+}
+
+// ========== Sparse Twinkle Tests ==========
+
+void test_twinkle_gap_is_geometric() {
+    std::srand(7);
+    // Geometric(1/16): mean gap 15, P(gap == 0) = 1/16
+    const int SAMPLES = 20000;
+    long sum = 0;
+    int zeros = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        uint32_t gap = TwinkleField<64, 16, 8>::sampleGap();
+        sum += gap;
+        if (gap == 0) zeros++;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.6f, 15.0f, (float)sum / SAMPLES);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f / 16, (float)zeros / SAMPLES);
+}
+
+void test_twinkle_event_rate_matches_density() {
+    std::srand(11);
+    // Every event is one call to newTarget: expect frames * LEDs / DENSITY of them
+    static TwinkleField<200, 8, 255> field;
+    field.reset(20);
+    long events = 0;
+    uint16_t maxIndex = 0;
+    for (int frame = 0; frame < 500; frame++) {
+        field.update([&](uint16_t index) {
+            events++;
+            if (index > maxIndex) maxIndex = index;
+            return (uint8_t)100;
+        });
+    }
+    TEST_ASSERT_INT_WITHIN(500, 500 * 200 / 8, events);
+    TEST_ASSERT_TRUE(maxIndex < 200);
+}
+
+void test_twinkle_fades_to_target_then_goes_idle() {
+    std::srand(3);
+    static TwinkleField<100, 4, 10> field;
+    field.reset(20);
+    TEST_ASSERT_EQUAL(0, field.activeCount());
+
+    // Run until at least one LED picks a target
+    uint8_t picked[100] = {};
+    bool any = false;
+    while (!any) {
+        field.update([&](uint16_t index) {
+            picked[index] = 1;
+            any = true;
+            return (uint8_t)125;
+        });
+    }
+    TEST_ASSERT_TRUE(field.activeCount() > 0);
+
+    // Later events keep each LED's target, so the active set drains: 105 / 10 -> 11 frames
+    for (int frame = 0; frame < 11; frame++) {
+        field.update([&](uint16_t index) { return (uint8_t)(picked[index] ? 125 : 20); });
+    }
+    TEST_ASSERT_EQUAL(0, field.activeCount());
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL(picked[i] ? 125 : 20, field.brightness(i));
+    }
+}
+
+// Animation frame interval
+const unsigned long TWINKLE_FRAME_MS = 50;
+
+void test_monochromatic_twinkle_render_is_rng_free() {
+    static MonochromaticTwinkle<TEST_CHANNELS, TEST_LEDS> anim;
+    static CRGB ch[4][TEST_LEDS];
+    static CRGB again[4][TEST_LEDS];
+    const int hues[] = {0, 90, 180, 270};
+    anim.setChannelHues(hues);
+    anim.begin();
+    anim.update(TWINKLE_FRAME_MS);
+
+    // Render draws no random numbers and is repeatable between updates (no flicker)
+    std::srand(5);
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    CRGB* againStrips[] = {again[0], again[1], again[2], again[3]};
+    anim.render(strips);
+    int afterRender = std::rand();
+    std::srand(5);
+    TEST_ASSERT_EQUAL(std::rand(), afterRender);
+
+    anim.render(againStrips);
+    for (int c = 0; c < 4; c++) {
+        for (int i = 0; i < TEST_LEDS; i++) {
+            TEST_ASSERT_EQUAL(ch[c][i].r, again[c][i].r);
+            TEST_ASSERT_EQUAL(ch[c][i].g, again[c][i].g);
+            TEST_ASSERT_EQUAL(ch[c][i].b, again[c][i].b);
+        }
+    }
+}
+
+void test_monochromatic_twinkle_benchmark() {
+    static MonochromaticTwinkle<TEST_CHANNELS, TEST_LEDS> anim;
+    static CRGB ch[4][TEST_LEDS];
+    const int hues[] = {0, 90, 180, 270};
+    anim.setChannelHues(hues);
+    anim.begin();
+
+    CRGB* strips[] = {ch[0], ch[1], ch[2], ch[3]};
+    double us = benchmarkUs(2000, [&]() {
+        anim.update(TWINKLE_FRAME_MS);
+        anim.render(strips);
+    });
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Monochromatic Twinkle: %.1f us/frame", us);
+    TEST_MESSAGE(msg);
+}
+
+// ========== Notification Scheduler Tests ==========
+
+static CRGB notifyCh[4][8];
+static CRGB* const notifyStrips[] = {notifyCh[0], notifyCh[1], notifyCh[2], notifyCh[3]};
+
+static bool notifyUpdate(NotificationScheduler& sched, unsigned long now) {
+    bool changed = sched.update(notifyStrips, 4, 8, now);
+    if (changed) sched.repaint(notifyStrips, 4, 8, now);
+    return changed;
+}
+
+void test_scheduler_duration_completes_without_blocking() {
+    NotificationScheduler sched;
+    uint16_t id = sched.enqueue({PATTERN_SOLID, CRGB::Green, 0, 3000, PRIORITY_NORMAL}, 0);
+    TEST_ASSERT_NOT_EQUAL(0, id);
+
+    notifyUpdate(sched, 0);
+    TEST_ASSERT_EQUAL(id, sched.activeId());
+    TEST_ASSERT_EQUAL(255, notifyCh[0][0].g);
+
+    notifyUpdate(sched, 2990);
+    TEST_ASSERT_TRUE(sched.isPending(id));
+    notifyUpdate(sched, 3000);
+    TEST_ASSERT_FALSE(sched.isPending(id));
+    TEST_ASSERT_TRUE(sched.isEmpty());
+}
+
+void test_scheduler_cycles_complete() {
+    NotificationScheduler sched;
+    uint16_t id = sched.enqueue({PATTERN_WARNING, CRGB::Red, 3, 0, PRIORITY_CRITICAL}, 0);
+
+    unsigned long now = 0;
+    notifyUpdate(sched, now);
+    while (sched.isPending(id) && now < 20000) {
+        now += 10;
+        notifyUpdate(sched, now);
+    }
+
+    // 3 cycles x 8 steps x 300ms
+    TEST_ASSERT_EQUAL(7200, now);
+}
+
+void test_scheduler_priority_then_fifo() {
+    NotificationScheduler sched;
+    uint16_t low = sched.enqueue({PATTERN_SOLID, CRGB::Blue, 0, 100, PRIORITY_LOW}, 0);
+    uint16_t first = sched.enqueue({PATTERN_SOLID, CRGB::Red, 0, 100, PRIORITY_HIGH}, 0);
+    uint16_t second = sched.enqueue({PATTERN_SOLID, CRGB::Green, 0, 100, PRIORITY_HIGH}, 0);
+
+    notifyUpdate(sched, 0);
+    TEST_ASSERT_EQUAL(first, sched.activeId());
+    notifyUpdate(sched, 100);
+    TEST_ASSERT_EQUAL(second, sched.activeId());
+    notifyUpdate(sched, 200);
+    TEST_ASSERT_EQUAL(low, sched.activeId());
+}
+
+void test_scheduler_preempts_and_resumes_remaining_time() {
+    NotificationScheduler sched;
+    uint16_t background = sched.enqueue({PATTERN_SOLID, CRGB::Blue, 0, 1000, PRIORITY_LOW}, 0);
+    notifyUpdate(sched, 0);
+    notifyUpdate(sched, 400);   // 400ms of 1000ms shown
+
+    uint16_t urgent = sched.enqueue({PATTERN_SOLID, CRGB::Red, 0, 500, PRIORITY_CRITICAL}, 400);
+    TEST_ASSERT_TRUE(notifyUpdate(sched, 400));
+    TEST_ASSERT_EQUAL(urgent, sched.activeId());
+    TEST_ASSERT_EQUAL(255, notifyCh[0][0].r);
+
+    notifyUpdate(sched, 900);   // Urgent completes, background resumes
+    TEST_ASSERT_EQUAL(background, sched.activeId());
+    TEST_ASSERT_EQUAL(255, notifyCh[0][0].b);
+
+    // Preempted time does not count: 600ms remain from 900
+    notifyUpdate(sched, 1400);
+    TEST_ASSERT_TRUE(sched.isPending(background));
+    notifyUpdate(sched, 1500);
+    TEST_ASSERT_FALSE(sched.isPending(background));
+}
+
+void test_scheduler_rejects_when_full() {
+    NotificationScheduler sched;
+    for (uint8_t i = 0; i < NotificationScheduler::MAX_QUEUED; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, sched.enqueue({PATTERN_SOLID, CRGB::Red, 0, 0, PRIORITY_LOW}, 0));
+    }
+    TEST_ASSERT_EQUAL(0, sched.enqueue({PATTERN_SOLID, CRGB::Red, 0, 0, PRIORITY_LOW}, 0));
+    TEST_ASSERT_EQUAL(NotificationScheduler::MAX_QUEUED, sched.size());
+}
+
+// ========== Keyframe Pattern Tests ==========
+
+void test_keyframe_regions_target_any_channel_and_range() {
+    CRGB leds[4][16];
+    CRGB* const strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    NotificationState state;
+    state.start(PATTERN_WIFI_CONNECTING, CRGB::Black, 0, 0);
+    state.repaint(strips, 4, 16, 0);
+
+    // Halfway through the eased fade on channel 1, LED 0 only
+    state.update(strips, 4, 16, 375);
+    TEST_ASSERT_INT_WITHIN(20, 128, leds[0][0].b);
+    TEST_ASSERT_EQUAL(0, leds[0][1].b);
+    TEST_ASSERT_EQUAL(0, leds[1][0].b);
+
+    // Fade complete
+    state.update(strips, 4, 16, 750);
+    TEST_ASSERT_EQUAL(255, leds[0][0].b);
+}
+
+void test_keyframe_to_end_clamps_to_strip() {
+    CRGB leds[4][16];
+    CRGB* const strips[] = {leds[0], leds[1], leds[2], leds[3]};
+    NotificationState state;
+    state.start(PATTERN_IDENTIFY, CRGB::White, 1, 0);
+    state.repaint(strips, 4, 16, 0);
+    state.update(strips, 4, 16, 500);
+    for (int ch = 0; ch < 4; ch++) {
+        TEST_ASSERT_EQUAL(255, leds[ch][15].r);
+    }
+    TEST_ASSERT_FALSE(state.update(strips, 4, 16, 1000));
+}
+
+// ========== Button Input Tests ==========
+
+// Drain all debounced events up to 'now'; returns count, last event in 'last'
+static int drainButton(ButtonInput& button, unsigned long now, ButtonEvent& last) {
+    int count = 0;
+    ButtonEvent event;
+    while (button.poll(now, event)) {
+        last = event;
+        count++;
+    }
+    return count;
+}
+
+void test_button_bouncy_press_and_release_debounced() {
+    ButtonInput button(39, 50);
+    ButtonEvent last;
+
+    // Press at 100 with contact bounce
+    button.recordEdge(100, true);
+    button.recordEdge(102, false);
+    button.recordEdge(103, true);
+    button.recordEdge(105, false);
+    button.recordEdge(107, true);
+    TEST_ASSERT_EQUAL(1, drainButton(button, 110, last));
+    TEST_ASSERT_EQUAL(BUTTON_PRESSED, last.type);
+    TEST_ASSERT_EQUAL(100, last.timestampMs);
+    TEST_ASSERT_TRUE(button.isPressed());
+
+    // Release at 900 with bounce
+    button.recordEdge(900, false);
+    button.recordEdge(901, true);
+    button.recordEdge(904, false);
+    TEST_ASSERT_EQUAL(1, drainButton(button, 1000, last));
+    TEST_ASSERT_EQUAL(BUTTON_RELEASED, last.type);
+    TEST_ASSERT_EQUAL(800, last.heldMs);
+    TEST_ASSERT_FALSE(button.isPressed());
+}
+
+void test_button_change_inside_window_accepted_after_settling() {
+    ButtonInput button(39, 50);
+    ButtonEvent last;
+
+    button.recordEdge(100, true);
+    button.recordEdge(120, false);   // Real release, but inside the bounce window
+    TEST_ASSERT_EQUAL(1, drainButton(button, 130, last));
+    TEST_ASSERT_TRUE(button.isPressed());
+
+    // Once the window closes the release is accepted
+    TEST_ASSERT_EQUAL(1, drainButton(button, 150, last));
+    TEST_ASSERT_EQUAL(BUTTON_RELEASED, last.type);
+    TEST_ASSERT_EQUAL(150, last.timestampMs);
+}
+
+void test_button_long_press_from_timestamps() {
+    ButtonInput button(0, 50);
+    ButtonEvent last;
+
+    button.recordEdge(1000, true);
+    drainButton(button, 1000, last);
+    TEST_ASSERT_EQUAL(1999, button.heldFor(2999));
+    TEST_ASSERT_EQUAL(2000, button.heldFor(3000));
+
+    // Edge newer than the frame clock must not read as a huge hold
+    button.recordEdge(5000, false);
+    button.recordEdge(5100, true);
+    drainButton(button, 5200, last);
+    TEST_ASSERT_EQUAL(0, button.heldFor(5050));
+}
+
+void test_button_glitch_without_level_change_ignored() {
+    ButtonInput button(39, 50);
+    ButtonEvent last;
+
+    button.recordEdge(500, false);   // Spurious interrupt, level still released
+    TEST_ASSERT_EQUAL(0, drainButton(button, 1000, last));
+    TEST_ASSERT_FALSE(button.isPressed());
+}
+
+void test_edge_queue_counts_dropped_edges() {
+    EdgeQueue<4> queue;
+    for (int i = 0; i < 5; i++) {
+        queue.push({(unsigned long)i, (i % 2) == 0});
+    }
+    TEST_ASSERT_EQUAL(2, queue.droppedCount());  // Capacity 4 holds 3
+
+    ButtonEdge edge;
+    TEST_ASSERT_TRUE(queue.pop(edge));
+    TEST_ASSERT_EQUAL(0, edge.timestampMs);
+}
+
+// ========== Loop Scheduler Tests ==========
+
+// Simulated clock: tasks "cost" time by advancing it
+static unsigned long simNowMs = 0;
+static unsigned long simClock() { return simNowMs; }
+static void simTaskFast() { simNowMs += 1; }     // e.g., HomeSpan poll
+static void simTaskRender() { simNowMs += 3; }   // e.g., frame render
+static void simTaskOutput() { simNowMs += 5; }   // e.g., show()
+
+// Mirror of loop(): run what is due, then sleep until the next deadline
+static void simulateLoop(TaskScheduler& sched, unsigned long untilMs) {
+    while (simNowMs < untilMs) {
+        sched.runDue();
+        unsigned long idle = sched.idleTime();
+        sched.noteIdle(idle);
+        simNowMs += idle;
+    }
+}
+
+void test_task_scheduler_meets_deadlines_and_idles() {
+    simNowMs = 0;
+    TaskScheduler sched(simClock);
+    int8_t fast = sched.addTask("fast", simTaskFast, 10);
+    int8_t render = sched.addTask("render", simTaskRender, 20);
+    int8_t output = sched.addTask("output", simTaskOutput, 50);
+
+    simulateLoop(sched, 10000);
+
+    TEST_ASSERT_INT_WITHIN(2, 1000, sched.getStats(fast).runs);
+    TEST_ASSERT_INT_WITHIN(2, 500, sched.getStats(render).runs);
+    TEST_ASSERT_INT_WITHIN(2, 200, sched.getStats(output).runs);
+
+    // A task is never later than the other tasks' combined cost
+    TEST_ASSERT_LESS_OR_EQUAL(8, sched.getStats(fast).maxLatenessMs);
+    TEST_ASSERT_LESS_OR_EQUAL(6, sched.getStats(render).maxLatenessMs);
+    TEST_ASSERT_LESS_OR_EQUAL(4, sched.getStats(output).maxLatenessMs);
+
+    // Load is 1/10 + 3/20 + 5/50 = 35%, so ~65% idle
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Simulated idle: %d%%", sched.idlePercent());
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_INT_WITHIN(3, 65, sched.idlePercent());
+}
+
+static void simTaskOverrun() { simNowMs += 35; }
+
+void test_task_scheduler_skips_missed_slots() {
+    simNowMs = 0;
+    TaskScheduler sched(simClock);
+    int8_t slow = sched.addTask("slow", simTaskOverrun, 10);
+
+    simulateLoop(sched, 1000);
+
+    // Overrunning task runs back-to-back at its own pace, never in catch-up bursts
+    TEST_ASSERT_INT_WITHIN(2, 1000 / 45, sched.getStats(slow).runs);
+    TEST_ASSERT_LESS_OR_EQUAL(10, sched.getStats(slow).maxLatenessMs);
+}
+
+void test_task_scheduler_next_deadline_override() {
+    simNowMs = 0;
+    TaskScheduler sched(simClock);
+    int8_t lazy = sched.addTask("lazy", simTaskFast, 10);
+    sched.runDue();
+    sched.setNextDeadline(lazy, 500);
+    TEST_ASSERT_EQUAL(499, sched.idleTime());
+
+    sched.wake(lazy);
+    TEST_ASSERT_EQUAL(0, sched.idleTime());
+    TEST_ASSERT_EQUAL(1, sched.runDue());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Markov transition tests
+    RUN_TEST(test_markov_transition_returns_valid_values);
+    RUN_TEST(test_markov_transition_momentum_positive);
+    RUN_TEST(test_markov_transition_momentum_negative);
+    RUN_TEST(test_markov_transition_neutral_distribution);
+    RUN_TEST(test_markov_brightness_biased_upward_trend);
+
+    // Generate spread tests
+    RUN_TEST(test_generate_spread_centered);
+    RUN_TEST(test_generate_spread_bounded);
+
+    // Harmony tests
+    RUN_TEST(test_harmony_pick_uses_leaf_offsets);
+    RUN_TEST(test_harmony_pick_monochromatic_is_primary);
+    RUN_TEST(test_harmony_palette_matches_hsv);
+    RUN_TEST(test_harmony_twinkle_brightness_moves_only_delta_leds);
+
+    // Channel layout tests
+    RUN_TEST(test_layout_8x600_renders_every_strip);
+    RUN_TEST(test_layout_state_scales_with_hardware);
+
+    // Canvas layout tests
+    RUN_TEST(test_canvas_default_layout_is_identity);
+    RUN_TEST(test_canvas_segment_spans_channels);
+    RUN_TEST(test_canvas_zones_leave_unmapped_leds_black);
+    RUN_TEST(test_canvas_animation_renders_without_layout_knowledge);
+
+    // Frame slicing tests
+    RUN_TEST(test_slicer_stops_at_budget_and_resumes);
+    RUN_TEST(test_slice_size_is_independent_of_strip_length);
+    RUN_TEST(test_sliced_frame_does_not_depend_on_budget);
+    RUN_TEST(test_sliced_twinkle_matches_update_and_render);
+    RUN_TEST(test_sliced_frames_cover_every_led);
+    RUN_TEST(test_slicing_benchmark);
+
+    // Quality governor tests
+    RUN_TEST(test_governor_degrades_over_budget_and_recovers);
+    RUN_TEST(test_quality_level_is_clamped_to_declared_levels);
+    RUN_TEST(test_governor_keeps_frame_time_within_budget_under_load);
+    RUN_TEST(test_reduced_quality_steps_base_layer_every_other_frame);
+    RUN_TEST(test_quality_levels_benchmark);
+
+    // Base layer detail tests
+    RUN_TEST(test_base_lod_sizes_state_by_decimation);
+    RUN_TEST(test_base_lod_upsamples_smoothly);
+    RUN_TEST(test_base_lod_steps_only_grid_points);
+    RUN_TEST(test_base_lod_follows_quality_without_jumps);
+    RUN_TEST(test_base_lod_benchmark);
+
+    // Runner motion tests
+    RUN_TEST(test_subpixel_lut_phases_shift_the_blob);
+    RUN_TEST(test_runner_renders_between_pixels);
+    RUN_TEST(test_runner_speed_independent_of_frame_rate);
+    RUN_TEST(test_runner_spawns_at_frame_rate_speed);
+
+    // Particle pool tests
+    RUN_TEST(test_particle_pool_allocates_lowest_free_slot);
+    RUN_TEST(test_particle_pool_iterates_active_slots);
+    RUN_TEST(test_occupancy_map_ranges);
+    RUN_TEST(test_raindrop_collisions_match_distance_rule);
+    RUN_TEST(test_particle_pool_benchmark);
+
+    // Noise base layer tests
+    RUN_TEST(test_noise_base_seeks_to_any_time);
+    RUN_TEST(test_noise_base_is_smooth_and_bounded);
+    RUN_TEST(test_noise_base_half_rate_keeps_time);
+    RUN_TEST(test_noise_base_sliced_frame_matches_whole);
+    RUN_TEST(test_noise_base_benchmark);
+
+    // Frame rate tests
+    RUN_TEST(test_frame_interval_helpers_clamp);
+    RUN_TEST(test_frame_interval_follows_content);
+    RUN_TEST(test_frames_run_at_the_animation_rate);
+
+    // LED output tests
+    RUN_TEST(test_wire_model_matches_ws2811_timing);
+    RUN_TEST(test_simulated_output_reports_topology_fps);
+    RUN_TEST(test_simulated_output_blocking_vs_async);
+
+    // Wire encoding tests
+    RUN_TEST(test_wire_framebuffer_matches_reference_encoder);
+    RUN_TEST(test_wire_framebuffer_benchmark);
+
+    // Frame interpolation tests
+    RUN_TEST(test_swar_lerp_matches_scalar);
+    RUN_TEST(test_interpolator_blends_over_one_frame_interval);
+    RUN_TEST(test_interpolator_early_frame_does_not_jump);
+    RUN_TEST(test_interpolation_benchmark);
+
+    // Power limiter tests
+    RUN_TEST(test_power_estimate_matches_led_model);
+    RUN_TEST(test_power_estimate_from_output_stage_sums);
+    RUN_TEST(test_power_limiter_stays_within_budget);
+    RUN_TEST(test_power_limiter_recovers_smoothly);
+
+    // Output stage tests
+    RUN_TEST(test_output_stage_applies_gamma);
+    RUN_TEST(test_output_stage_color_correction);
+    RUN_TEST(test_output_stage_dithering_averages_to_exact_level);
+    RUN_TEST(test_output_stage_reprocessing_keeps_dither_phase);
+    RUN_TEST(test_output_stage_benchmark);
+
+    // Lookup table tests
+    RUN_TEST(test_lut_hue8_matches_map);
+    RUN_TEST(test_lut_curves_match_float);
+    RUN_TEST(test_lut_gaussian_matches_expf);
+
+    // Fixed-point tests
+    RUN_TEST(test_fixed_q8_8_matches_float);
+    RUN_TEST(test_fixed_q16_16_precision);
+    RUN_TEST(test_fixed_saturates);
+    RUN_TEST(test_fixed_twinkle_target_matches_float);
+
+    // Sparse twinkle tests
+    RUN_TEST(test_twinkle_gap_is_geometric);
+    RUN_TEST(test_twinkle_event_rate_matches_density);
+    RUN_TEST(test_twinkle_fades_to_target_then_goes_idle);
+    RUN_TEST(test_monochromatic_twinkle_render_is_rng_free);
+    RUN_TEST(test_monochromatic_twinkle_benchmark);
+
+    // Notification scheduler tests
+    RUN_TEST(test_scheduler_duration_completes_without_blocking);
+    RUN_TEST(test_scheduler_cycles_complete);
+    RUN_TEST(test_scheduler_priority_then_fifo);
+    RUN_TEST(test_scheduler_preempts_and_resumes_remaining_time);
+    RUN_TEST(test_scheduler_rejects_when_full);
+
+    // Keyframe pattern tests
+    RUN_TEST(test_keyframe_regions_target_any_channel_and_range);
+    RUN_TEST(test_keyframe_to_end_clamps_to_strip);
+
+    // Button input tests
+    RUN_TEST(test_button_bouncy_press_and_release_debounced);
+    RUN_TEST(test_button_change_inside_window_accepted_after_settling);
+    RUN_TEST(test_button_long_press_from_timestamps);
+    RUN_TEST(test_button_glitch_without_level_change_ignored);
+    RUN_TEST(test_edge_queue_counts_dropped_edges);
+
+    // Loop scheduler tests
+    RUN_TEST(test_task_scheduler_meets_deadlines_and_idles);
+    RUN_TEST(test_task_scheduler_skips_missed_slots);
+    RUN_TEST(test_task_scheduler_next_deadline_override);
 
     return UNITY_END();
 }